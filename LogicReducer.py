@@ -1,8 +1,9 @@
 # **************************************************************************************************
 # @file LogicReducer.py
-# @brief converts a truth table stored into a text file into a list of minterms. These are fed to 
-# the C++ Petrick program so that they get reduced. With this program you will get all the reduced 
-# expressions for the columns at the right of the truth table.
+# @brief feeds a truth table stored into a text file to the C++ Petrick program so that it gets 
+# reduced. With this program you will get all the reduced expressions for the columns at the right 
+# of the truth table. If the petrick library (see petrick.h) is next to this file, it is called 
+# directly instead of running the petrick program.
 #
 # @project   Logic Function Reducer
 # @version   1.0
@@ -15,6 +16,7 @@
 
 import shlex, os, subprocess
 import argparse
+import ctypes
 
 # Verifies if the provided filepath is a valid, readable file.
 def verifyFile(filepath: str) -> bool:
@@ -35,16 +37,6 @@ def verifyFile(filepath: str) -> bool:
 
     return True
 
-def fromRowToNumbers(input: str) -> list[int]:
-    ret = []
-    if 'x' in input:
-        ret.extend(fromRowToNumbers(input.replace('x', '0', 1)))
-        ret.extend(fromRowToNumbers(input.replace('x', '1', 1)))
-    else:
-        input = input.replace(' ', '')
-        ret.append(int(input, 2))
-    return ret
-
 def executeCommand(cmd: str, cwd: str):
     commandArgs = shlex.split(cmd)
     # So that the windowed application doesn't open a terminal to run the code on Windows (nt).
@@ -75,7 +67,157 @@ def executeCommand(cmd: str, cwd: str):
             stderr = runResult.stderr
         )
     
-    print(runResult.stdout.decode('utf-8'))
+    return runResult.stdout.decode('utf-8')
+
+# Structures of petrick.h.
+class PetrickCube(ctypes.Structure):
+    _fields_ = [('value', ctypes.c_uint64), ('mask', ctypes.c_uint64)]
+
+class PetrickFunction(ctypes.Structure):
+    _fields_ = [('onSet',    ctypes.POINTER(PetrickCube)), ('onCount',  ctypes.c_size_t),
+                ('dncSet',   ctypes.POINTER(PetrickCube)), ('dncCount', ctypes.c_size_t)]
+
+class PetrickOptions(ctypes.Structure):
+    _fields_ = [('solver',          ctypes.c_int), ('maxProducts', ctypes.c_int),
+                ('costLimit',       ctypes.c_int), ('threads',     ctypes.c_int),
+                ('multipleOutputs', ctypes.c_int), ('cachePath',   ctypes.c_char_p),
+                ('timeLimit',       ctypes.c_double), ('memLimit', ctypes.c_int),
+                ('bddPrimes',       ctypes.c_int)]
+
+class PetrickResult(ctypes.Structure):
+    _fields_ = [('cubes',     ctypes.POINTER(PetrickCube)), ('cubeCount', ctypes.c_size_t),
+                ('operations', ctypes.c_int), ('andCount', ctypes.c_int), ('orCount', ctypes.c_int),
+                ('notCount',   ctypes.c_int), ('optimal',  ctypes.c_int)]
+
+# Loads the petrick library of the directory, or returns None if it isn't there.
+def loadPetrickLibrary(cwd: str):
+    name = "petrick.dll" if os.name == 'nt' else "libpetrick.so"
+    path = os.path.join(cwd, name)
+    if not os.path.isfile(path):
+        return None
+    try:
+        lib = ctypes.CDLL(path)
+    except OSError:
+        return None
+
+    lib.petrickDefaultOptions.restype = PetrickOptions
+    lib.petrickReduceFunctions.restype = ctypes.c_int
+    lib.petrickReduceFunctions.argtypes = [ctypes.c_int, ctypes.c_size_t, ctypes.POINTER(PetrickFunction),
+                                           ctypes.POINTER(PetrickOptions), ctypes.POINTER(PetrickResult),
+                                           ctypes.POINTER(PetrickResult), ctypes.c_char_p, ctypes.c_size_t]
+    lib.petrickFreeResult.argtypes = [ctypes.POINTER(PetrickResult)]
+    return lib
+
+# Reads the rows of a truth table as readTruthTable on petrick.cpp does: a list of (inputs, outputs).
+def readTruthTable(filepath: str):
+    rows = []
+    with open(filepath) as file:
+        for lineNumber, line in enumerate(file, 1):
+            line = "".join(line.split())
+            if not line:
+                continue
+            inputs, bar, outputs = line.partition('|')
+            if not bar or not inputs or not outputs or any(c not in "01xX-" for c in inputs + outputs):
+                raise ValueError(f"Invalid row on line {lineNumber} of the truth table.")
+            if rows and (len(inputs) != len(rows[0][0]) or len(outputs) != len(rows[0][1])):
+                raise ValueError(f"The row on line {lineNumber} of the truth table has a different "
+                                 "number of inputs or outputs than the first one.")
+            rows.append((inputs, outputs))
+    if not rows:
+        raise ValueError("The truth table is empty.")
+    return rows
+
+# Name of the input, from the first one, as getInputName on petrick.cpp.
+def getInputName(input: int) -> str:
+    letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    return letters[input % 52] + (str(input // 52) if input >= 52 else "")
+
+# Reduces each output of a truth table on its own call to petrick, with its lists of minterms and
+# Do-Not-Care bits, for the petrick programs built before --table (as the petrick.exe of the repo).
+def reduceEachOutput(petrick: str, filepath: str, optionalArgs: str, cwd: str):
+    rows = readTruthTable(filepath)
+    numInputs = len(rows[0][0])
+    for index in range(len(rows[0][1])):
+        minterms, dnc = set(), set()
+        for inputs, outputs in rows:
+            if outputs[index] == '0':
+                continue
+            # The x inputs of the row stand for both 0 and 1.
+            values = [0]
+            for c in inputs:
+                bits = [0] if c == '0' else [1] if c == '1' else [0, 1]
+                values = [2*v + bit for v in values for bit in bits]
+            (minterms if outputs[index] == '1' else dnc).update(values)
+        dnc -= minterms
+        mstr = "[" + ",".join(map(str, sorted(minterms))) + "]"
+        dstr = "[" + ",".join(map(str, sorted(dnc))) + "]"
+        result = executeCommand(f"{petrick} {optionalArgs} {numInputs} {mstr} {dstr}", cwd)
+        print(result.replace("Q:", f"Q{index}:", 1), end="")
+
+# @return true if the petrick program reads the truth tables itself (with --table).
+def readsTables(petrick: str, cwd: str) -> bool:
+    return "--table" in executeCommand(f"{petrick} -h", cwd)
+
+# Formats the gates of a result as petrick does.
+def formatOperations(result) -> str:
+    return f"{result.operations}(AND: {result.andCount}, OR: {result.orCount}, NOT: {result.notCount})"
+
+# Reduces the functions of a truth table with the petrick library and prints them as petrick does.
+def reduceWithLibrary(lib, filepath: str, multiple: bool, jobs: int):
+    rows = readTruthTable(filepath)
+    numInputs = len(rows[0][0])
+    if numInputs > 64:
+        raise ValueError("The petrick library only reduces functions of up to 64 inputs.")
+
+    # The cubes of each output. Each row is a single cube, as on getTableFunctions.
+    sets = [([], []) for _ in rows[0][1]]
+    for inputs, outputs in rows:
+        value = int("".join('1' if c == '1' else '0' for c in inputs), 2)
+        mask = int("".join('1' if c in "01" else '0' for c in inputs), 2)
+        for i, c in enumerate(outputs):
+            if c != '0':
+                sets[i][0 if c == '1' else 1].append(PetrickCube(value, mask))
+
+    # The arrays of cubes are kept on this list while they are used by the library.
+    arrays = []
+    functions = (PetrickFunction * len(sets))()
+    for i, (onSet, dncSet) in enumerate(sets):
+        onArray = (PetrickCube * max(1, len(onSet)))(*onSet)
+        dncArray = (PetrickCube * max(1, len(dncSet)))(*dncSet)
+        arrays += [onArray, dncArray]
+        functions[i] = PetrickFunction(onArray, len(onSet), dncArray, len(dncSet))
+
+    options = lib.petrickDefaultOptions()
+    options.multipleOutputs = int(multiple)
+    options.threads = max(1, jobs)
+    results = (PetrickResult * len(sets))()
+    total = PetrickResult()
+    error = ctypes.create_string_buffer(256)
+    if lib.petrickReduceFunctions(numInputs, len(sets), functions, ctypes.byref(options), results,
+                                  ctypes.byref(total), error, len(error)) != 0:
+        raise ValueError(error.value.decode('utf-8'))
+
+    lines = []
+    for i, result in enumerate(results):
+        if result.cubeCount == 0:
+            lines.append(f"Q{i}: 0")
+            continue
+        terms = []
+        for c in range(result.cubeCount):
+            cube = result.cubes[c]
+            term = ""
+            for input in range(numInputs):
+                bit = numInputs - 1 - input
+                if (cube.mask >> bit) & 1:
+                    term += ("" if (cube.value >> bit) & 1 else "#") + getInputName(input)
+            # A cube without literals is the constant 1.
+            terms.append(term or "1")
+        expression = terms[0] if len(terms) == 1 else "[" + "+".join(terms) + "]"
+        lines.append(f"Q{i}: {expression}  Number of operations: {formatOperations(result)}")
+        lib.petrickFreeResult(ctypes.byref(result))
+    if multiple:
+        lines.append(f"Total number of operations: {formatOperations(total)}")
+    print("\n".join(lines) + "\n")
 
 def main():
     parser = argparse.ArgumentParser(
@@ -88,6 +230,10 @@ def main():
                         help='Verbose mode displays more info on the process.')
     parser.add_argument('-c', '--colored', action='store_true', 
                         help='Negated terms shown in red, non-negated in green.')
+    parser.add_argument('-m', '--multiple', action='store_true', 
+                        help='Minimize all the outputs together, so that they can share their product terms.')
+    parser.add_argument('-j', '--jobs', type=int, default=0, metavar='N',
+                        help='Minimize up to N outputs at the same time.')
     parser.add_argument('file', type=str, 
                         help='The path to the text file containing the truth table.')
     
@@ -95,47 +241,39 @@ def main():
     if not verifyFile(args.file):
         exit(-1)
 
-    # Store all the functions.
-    minterms: list[list[int]]   = []
-    dnc: list[list[int]]        = []
-
+    # The library doesn't print the verbose or colored output, which is left to the petrick program.
     cwd = os.path.dirname(os.path.abspath(__file__))
+    lib = None if args.verbose or args.colored else loadPetrickLibrary(cwd)
+    if lib:
+        try:
+            reduceWithLibrary(lib, args.file, args.multiple, args.jobs)
+        except ValueError as e:
+            print(f"Error: {e}")
+            exit(-1)
+        return
+
+    optionalArgs = ""
+    if args.verbose: optionalArgs += "-v "
+    if args.colored: optionalArgs += "-c "
+    if args.multiple: optionalArgs += "-m "
+    if args.jobs: optionalArgs += f"-j{args.jobs} "
+    petrick = "petrick.exe" if os.name == 'nt' else "./petrick"
+    if not os.path.isfile(os.path.join(cwd, petrick)):
+        print(f"Error: {petrick} was not found next to LogicReducer.py. Compile petrick.cpp first "
+              "(see 'How to compile' on README.md).")
+        exit(-1)
+
+    if not readsTables(petrick, cwd):
+        if args.multiple or args.jobs:
+            print(f"Error: {petrick} was built before -m and -j. Compile petrick.cpp again "
+                  "(see 'How to compile' on README.md).")
+            exit(-1)
+        reduceEachOutput(petrick, args.file, optionalArgs, cwd)
+        return
 
-    with open(args.file) as f:
-        lines = f.readlines()
-
-        inputCount = len(lines[0].split('|')[0].strip().split(" "))
-        outFuncCount = len(lines[0].split('|')[1].strip().split(" "))
-        minterms    = [[] for i in range(outFuncCount)]
-        dnc         = [[] for i in range(outFuncCount)]
-
-        for line in lines:
-            line = line.split("|")
-
-            inputs: list[int] = fromRowToNumbers(line[0].strip())
-            
-
-            outputs: list[str] = line[1].strip().split(' ')
-            for index, out in enumerate(outputs):
-                if out == '1':
-                    minterms[index].extend(inputs)
-                elif out == 'x':
-                    dnc[index].extend(inputs)
-
-        for index, (m, d) in enumerate(zip(minterms, dnc)):
-            print(f"Q{index}: {m}")
-            print(f"DNC{index}: {d}")
-            
-            mstr = str(m).replace(" ", "")
-            dstr = str(d).replace(" ", "")
-            optionalArgs = ""
-            if args.verbose: optionalArgs += "-v "
-            if args.colored: optionalArgs += "-c"
-
-            if os.name == 'nt':
-                executeCommand(f"petrick.exe {optionalArgs} {inputCount} {mstr} {dstr}", cwd)
-            else:
-                executeCommand(f"./petrick {optionalArgs} {inputCount} {mstr} {dstr}", cwd)
+    # Petrick reads the truth table itself, so all the outputs are reduced on a single call.
+    tablePath = os.path.abspath(args.file)
+    print(executeCommand(f"{petrick} {optionalArgs} {shlex.quote('--table=' + tablePath)}", cwd))
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
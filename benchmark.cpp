@@ -0,0 +1,276 @@
+/************************************************************************************************//*
+* @file benchmark.cpp
+* @brief Minimizes random functions with the solvers of petrick.cpp and reports the time and the peak
+* memory of each stage of the minimization as JSON, to compare the performance between versions.
+*
+* @project   Logic Function Reducer
+* @version   1.0
+* @date      2026-10-14
+* @author    @dabecart
+*
+* @license
+* This project is licensed under the MIT License - see the LICENSE file for details.
+***************************************************************************************************/
+
+#include <chrono>
+#include <random>
+#include <new>
+#include <cstdlib>
+
+#define PETRICK_LIBRARY
+#include "petrick.cpp"
+
+// Bytes allocated on the heap right now, and the most that have been allocated since the current 
+// stage started (see Benchmark::run).
+atomic<size_t> currentMemory(0);
+atomic<size_t> peakMemory(0);
+
+// Stored before each block given by operator new, to know its size when it is deleted.
+typedef struct AllocationHeader{
+  void *block;
+  size_t size;
+}AllocationHeader;
+
+void* trackedAllocate(size_t size, size_t alignment){
+  if(alignment < alignof(max_align_t)) alignment = alignof(max_align_t);
+  char *block = (char*) malloc(size + sizeof(AllocationHeader) + alignment - 1);
+  if(!block) throw bad_alloc();
+  uintptr_t address = ((uintptr_t) (block + sizeof(AllocationHeader)) + alignment - 1) & ~(uintptr_t) (alignment - 1);
+  AllocationHeader *header = (AllocationHeader*) address - 1;
+  header->block = block;
+  header->size = size;
+
+  size_t memory = currentMemory += size;
+  size_t peak = peakMemory;
+  while(memory > peak && !peakMemory.compare_exchange_weak(peak, memory)){}
+  return (void*) address;
+}
+
+void trackedFree(void *pointer){
+  if(!pointer) return;
+  AllocationHeader *header = (AllocationHeader*) pointer - 1;
+  currentMemory -= header->size;
+  free(header->block);
+}
+
+void* operator new(size_t size){ return trackedAllocate(size, 0); }
+void* operator new[](size_t size){ return trackedAllocate(size, 0); }
+void* operator new(size_t size, align_val_t alignment){ return trackedAllocate(size, (size_t) alignment); }
+void* operator new[](size_t size, align_val_t alignment){ return trackedAllocate(size, (size_t) alignment); }
+void operator delete(void *pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, align_val_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, align_val_t) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, size_t, align_val_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, size_t, align_val_t) noexcept { trackedFree(pointer); }
+
+// Stage of the minimization of a function, with the fastest time of all its runs and the most memory
+// it needed on any of them.
+typedef struct StageResult{
+  string name;
+  double milliseconds = 1e300;
+  size_t peakBytes = 0;
+}StageResult;
+
+// A random function of the benchmark: each minterm of numInputs inputs is a minterm of the function
+// with a probability of density, and a Do-Not-Care with a probability of dncDensity.
+typedef struct BenchmarkCase{
+  int numInputs;
+  double density;
+  double dncDensity;
+}BenchmarkCase;
+
+typedef struct Benchmark{
+  BenchmarkCase params;
+  uint64_t seed;
+  Minterms<uint32_t> minterms;
+  Minterms<uint32_t> dncs;
+  vector<StageResult> stages;
+  // Prime implicants of the function and operations of its result, which should be the same on
+  // every run.
+  int primeCount = 0;
+  int operationCount = 0;
+
+  Benchmark(BenchmarkCase c, uint64_t s) : params(c), seed(s){
+    // The seed of each case also depends on its parameters, so the functions don't change when other
+    // cases are added to the benchmark.
+    seed_seq sequence{(uint32_t) seed, (uint32_t) (seed >> 32), (uint32_t) c.numInputs,
+                      (uint32_t) (c.density*1e6), (uint32_t) (c.dncDensity*1e6)};
+    mt19937_64 random(sequence);
+    uniform_real_distribution<double> uniform(0, 1);
+    for(uint32_t m = 0; m < (1u << c.numInputs); m++){
+      double r = uniform(random);
+      if(r < c.density) minterms.push_back(m);
+      else if(r < c.density + c.dncDensity) dncs.push_back(m);
+    }
+    // Functions without minterms are not minimized, so they have at least one.
+    if(minterms.empty()){
+      minterms.push_back(dncs.empty() ? 0 : dncs.back().val);
+      if(!dncs.empty()) dncs.pop_back();
+    }
+  }
+
+  /**
+   * @brief Minimizes the function and keeps the fastest time and the largest peak memory of each stage.
+   * @param pool with the threads used to join the implicants.
+   */
+  void run(ThreadPool &pool){
+    ostringstream result;
+    Function<uint32_t> func(minterms, dncs, params.numInputs, "Q");
+    func.output = &result;
+    func.pool = &pool;
+
+    size_t stage = 0;
+    auto measure = [&](const char *name, auto body){
+      if(stage == stages.size()) stages.push_back(StageResult{name});
+      size_t startMemory = currentMemory;
+      peakMemory = startMemory;
+      auto start = chrono::steady_clock::now();
+      body();
+      chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+      stages[stage].milliseconds = min(stages[stage].milliseconds, elapsed.count());
+      stages[stage].peakBytes = max(stages[stage].peakBytes, peakMemory - startMemory);
+      stage++;
+    };
+
+    if(DEFAULT_OPTIONS.solver == SOLVER_ESPRESSO){
+      measure("espresso", [&](){ func.reduce(); });
+    }else{
+      measure("expandFunction", [&](){ func.expandFunction(); });
+      measure("calculateImplicants", [&](){ func.calculateImplicants(); });
+      measure("removeNonEssentialImplicants", [&](){ func.removeNonEssentialImplicants(); });
+      primeCount = func.imps.size();
+      measure("petrick", [&](){ func.petrick(); });
+    }
+
+    // The result ends with "Number of operations: <n>(AND: ...".
+    string text = result.str();
+    size_t position = text.rfind("Number of operations: ");
+    if(position != string::npos) operationCount = atoi(text.c_str() + position + 22);
+  }
+
+  void printJSON(ostream &stream){
+    stream << "{\"inputs\": " << params.numInputs << ", \"density\": " << params.density
+           << ", \"dncDensity\": " << params.dncDensity << ", \"minterms\": " << minterms.size()
+           << ", \"dncs\": " << dncs.size() << ", \"primes\": " << primeCount
+           << ", \"operations\": " << operationCount << ", \"stages\": [";
+    double total = 0;
+    for(size_t i = 0; i < stages.size(); i++){
+      if(i > 0) stream << ", ";
+      stream << "{\"name\": \"" << stages[i].name << "\", \"ms\": " << stages[i].milliseconds
+             << ", \"peakBytes\": " << stages[i].peakBytes << "}";
+      total += stages[i].milliseconds;
+    }
+    stream << "], \"totalMs\": " << total << "}";
+  }
+}Benchmark;
+
+void displayBenchmarkHelp(){
+  cout << "Usage: ./benchmark [-j<n>] [--solver=<s>] [--seed=<s>] [--repeat=<r>] [--dnc=<d>] [--output=<file>]\n"
+          "                   [<numInputs>:<density> ...]\n"
+          "Example: ./benchmark --seed=7 --repeat=5 8:0.3 12:0.1\n\n"
+          "Minimizes random functions of numInputs inputs whose minterms are chosen with a probability of\n"
+          "density, and prints the time (fastest of all the runs) and the peak memory of the heap of each\n"
+          "stage as JSON. Without cases, a default set of them is run.\n\n"
+          "Arguments:\n"
+          "-h  --help     : Display this help menu.\n"
+          "-j<n> -j <n> --jobs=<n>: Use n threads to join the implicants.\n"
+          "--solver=<s>   : Solver of petrick (sop, tree, bnb, espresso, greedy, ilp or auto). By default, sop.\n"
+          "--seed=<s>     : Seed of the random functions. By default, 1.\n"
+          "--repeat=<r>   : Times each function is minimized. By default, 3.\n"
+          "--dnc=<d>      : Probability of a minterm being a Do-Not-Care. By default, 0.05.\n"
+          "--output=<file>: Write the results to a file instead of the standard output.\n";
+}
+
+int main(int argc, char* argv[]){
+    uint64_t seed = 1;
+    int repeat = 3;
+    double dncDensity = 0.05;
+    string outputPath;
+    vector<BenchmarkCase> cases;
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        try {
+            if (option == "-h" || option == "--help") {
+                displayBenchmarkHelp();
+                return 0;
+            } else if (option.rfind("-j", 0) == 0 || option.rfind("--jobs=", 0) == 0) {
+                string threads = option[1] == 'j' ? option.substr(2) : option.substr(7);
+                // The number of threads may also be the next argument (-j 4).
+                if (option == "-j" && i+1 < argc && isdigit((unsigned char) argv[i+1][0])) threads = argv[++i];
+                THREADS = threads.empty() ? max<int>(1, thread::hardware_concurrency()) : stoi(threads);
+                if (THREADS < 1) throw invalid_argument(threads);
+            } else if (option.rfind("--solver=", 0) == 0) {
+                string solver = option.substr(9);
+                int s = 0;
+                while (s <= SOLVER_AUTO && solver != SOLVER_NAMES[s]) s++;
+                if (s > SOLVER_AUTO) throw invalid_argument(solver);
+                DEFAULT_OPTIONS.solver = (SolverType) s;
+            } else if (option.rfind("--seed=", 0) == 0) {
+                seed = stoull(option.substr(7));
+            } else if (option.rfind("--repeat=", 0) == 0) {
+                repeat = stoi(option.substr(9));
+                if (repeat < 1) throw invalid_argument(option);
+            } else if (option.rfind("--dnc=", 0) == 0) {
+                dncDensity = stod(option.substr(6));
+                if (dncDensity < 0 || dncDensity > 1) throw invalid_argument(option);
+            } else if (option.rfind("--output=", 0) == 0) {
+                outputPath = option.substr(9);
+            } else if (option[0] != '-' && option.find(':') != string::npos) {
+                BenchmarkCase c;
+                c.numInputs = stoi(option.substr(0, option.find(':')));
+                c.density = stod(option.substr(option.find(':')+1));
+                if (c.numInputs < 1 || c.numInputs > MAX_EXPANDED_INPUTS || c.density < 0 || c.density > 1) {
+                    throw invalid_argument(option);
+                }
+                cases.push_back(c);
+            } else {
+                cerr << "Error: Unknown option '" << option << "'.\n";
+                displayBenchmarkHelp();
+                return -1;
+            }
+        } catch (exception&) {
+            cerr << "Error: Invalid argument '" << option << "'.\n";
+            return -1;
+        }
+    }
+
+    if (cases.empty()) {
+        cases = {{4, 0.5, 0}, {6, 0.5, 0}, {8, 0.3, 0}, {9, 0.3, 0}, {10, 0.2, 0}, {12, 0.1, 0}, {14, 0.05, 0}};
+    }
+    for (BenchmarkCase &c : cases) {
+        c.dncDensity = min(dncDensity, 1 - c.density);
+    }
+
+    ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file) {
+            cerr << "Error: Cannot open the file '" << outputPath << "'.\n";
+            return -1;
+        }
+    }
+    ostream &output = outputPath.empty() ? cout : file;
+
+    ThreadPool pool(THREADS);
+    output << "{\"seed\": " << seed << ", \"solver\": \"" << SOLVER_NAMES[DEFAULT_OPTIONS.solver] << "\", \"threads\": "
+           << THREADS << ", \"repeat\": " << repeat << ", \"cases\": [\n";
+    try {
+        for (size_t c = 0; c < cases.size(); c++) {
+            Benchmark benchmark(cases[c], seed);
+            for (int r = 0; r < repeat; r++) benchmark.run(pool);
+            output << "  ";
+            benchmark.printJSON(output);
+            output << (c+1 < cases.size() ? ",\n" : "\n");
+            output.flush();
+        }
+    } catch (exception &e) {
+        cerr << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    output << "]}" << endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+/************************************************************************************************//*
+* @file incremental.cpp
+* @brief Changes random minterms of reduced functions with Function::addMinterm and removeMinterm, and
+* checks after each change that the prime implicants and the number of operations of the result are
+* the ones of the same function reduced from the beginning. It is run by regression.py.
+*
+* @project   Logic Function Reducer
+* @version   1.0
+* @date      2026-10-14
+* @author    @dabecart
+*
+* @license
+* This project is licensed under the MIT License - see the LICENSE file for details.
+***************************************************************************************************/
+
+#include <random>
+
+#define PETRICK_LIBRARY
+#include "petrick.cpp"
+
+// @return The keys of the prime implicants of the function, sorted so that they can be compared.
+vector<Implicant<uint32_t>::Key> getPrimeKeys(Function<uint32_t> &func){
+  vector<Implicant<uint32_t>::Key> keys;
+  for(Implicant<uint32_t> &imp : func.imps) keys.push_back(imp.getKey());
+  sort(keys.begin(), keys.end());
+  return keys;
+}
+
+// @return true if the cubes have each minterm of the given state (see main) and nothing else.
+bool cubesMatch(Implicants<uint32_t> &cubes, vector<int> &states, int state){
+  vector<bool> covered(states.size(), false);
+  for(Implicant<uint32_t> &cube : cubes){
+    cube.forEachMinterm([&](uint32_t m){ covered[m] = true; });
+  }
+  for(uint32_t m = 0; m < states.size(); m++){
+    if(covered[m] != (states[m] == state)) return false;
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]){
+    uint64_t seed = argc > 1 ? stoull(argv[1]) : 1;
+    int flipCount = 0, mismatches = 0;
+    mt19937_64 random(seed);
+
+    for (int numInputs = 3; numInputs <= 6; numInputs++) {
+        for (int trial = 0; trial < 20; trial++) {
+            // Each minterm is off (-1), on (0) or a Do-Not-Care (1), as Function::searchMinterm.
+            vector<int> states(1 << numInputs);
+            for (int &state : states) state = (int) (random() % 3) - 1;
+            Minterms<uint32_t> minterms, dncs;
+            for (uint32_t m = 0; m < states.size(); m++) {
+                if (states[m] == 0) minterms.push_back(m);
+                if (states[m] == 1) dncs.push_back(m);
+            }
+            Function<uint32_t> func(minterms, dncs, numInputs, "Q");
+            func.output = 0;
+            if (!minterms.empty()) func.reduce();
+
+            for (int flip = 0; flip < 25; flip++) {
+                uint32_t m = random() % states.size();
+                int state = (int) (random() % 3) - 1;
+                if (state == -1) func.removeMinterm(m);
+                else func.addMinterm(m, state == 1);
+                states[m] = state;
+                flipCount++;
+                if (!cubesMatch(func.onSet, states, 0) || !cubesMatch(func.dncSet, states, 1)) {
+                    cout << "The cubes do not match the minterms on " << numInputs << " inputs, trial " << trial
+                         << ", flip " << flip << "\n";
+                    mismatches++;
+                }
+
+                Minterms<uint32_t> freshMinterms, freshDncs;
+                for (uint32_t x = 0; x < states.size(); x++) {
+                    if (states[x] == 0) freshMinterms.push_back(x);
+                    if (states[x] == 1) freshDncs.push_back(x);
+                }
+                // As reduceFunctions, the functions without minterms are not reduced.
+                if (freshMinterms.empty()) continue;
+                Function<uint32_t> fresh(freshMinterms, freshDncs, numInputs, "Q");
+                fresh.output = 0;
+                fresh.reduce();
+                func.reduce();
+
+                int operations = func.resultAnd + func.resultOr + func.resultNot;
+                int freshOperations = fresh.resultAnd + fresh.resultOr + fresh.resultNot;
+                if (getPrimeKeys(func) != getPrimeKeys(fresh) || operations != freshOperations) {
+                    cout << "Mismatch on " << numInputs << " inputs, trial " << trial << ", flip " << flip
+                         << ": " << func.imps.size() << " primes and " << operations << " operations instead of "
+                         << fresh.imps.size() << " and " << freshOperations << "\n";
+                    mismatches++;
+                }
+            }
+        }
+    }
+    cout << flipCount << " changes, " << mismatches << " mismatches\n";
+    return mismatches == 0 ? 0 : 1;
+}
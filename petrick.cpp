@@ -15,22 +15,398 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <initializer_list>
+#include <map>
+#include <unordered_set>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <cctype>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
 #include <sstream>
+#include <fstream>
+#include <chrono>
+#include <array>
+#include <filesystem>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+// The ilp solver needs Z3: build with -DPETRICK_Z3 and link with -lz3.
+#ifdef PETRICK_Z3
+#include <z3++.h>
+#endif
+#include "petrick.h"
 
 using namespace std;
 
-bool VERBOSE = false;
-bool COLORED = false;
+typedef enum SolverType{
+  SOLVER_SOP,   // Petrick's method with the products stored as bitsets (SumOfProducts).
+  SOLVER_TREE,  // Petrick's method expanding the products with ImplicantOperation.
+  SOLVER_BNB,   // Branch and bound search of the cheapest cover (BranchAndBound).
+  SOLVER_ESPRESSO, // Heuristic minimization of the cubes of the function (Espresso).
+  SOLVER_GREEDY, // Greedy weighted set cover of the prime implicant chart (BranchAndBound::solveGreedy).
+  SOLVER_ILP,   // Exact cover of the chart as a 0-1 integer program solved by Z3 (IlpCover).
+  SOLVER_AUTO,  // One of the above, chosen by the size of the chart (see chooseCoverSolver).
+} SolverType;
 
-typedef struct Minterm{
-  int val;
+// Names of the solvers on the --solver option, in the order of SolverType.
+const char *SOLVER_NAMES[] = {"sop", "tree", "bnb", "espresso", "greedy", "ilp", "auto"};
+
+static_assert(PETRICK_SOLVER_SOP == SOLVER_SOP && PETRICK_SOLVER_TREE == SOLVER_TREE && 
+              PETRICK_SOLVER_BNB == SOLVER_BNB && PETRICK_SOLVER_ESPRESSO == SOLVER_ESPRESSO &&
+              PETRICK_SOLVER_GREEDY == SOLVER_GREEDY && PETRICK_SOLVER_ILP == SOLVER_ILP &&
+              PETRICK_SOLVER_AUTO == SOLVER_AUTO,
+              "The solvers of petrick.h must be the ones of SolverType");
+
+typedef enum OutputFormat{
+  FORMAT_TEXT,    // The expression and the gates of each function, as "Q: [a#c+b]  Number of operations: ...".
+  FORMAT_PLA,     // Berkeley PLA, with a row for each product term and a column for each function.
+  FORMAT_VERILOG, // A Verilog module with an assign statement for each function.
+  FORMAT_JSON,    // A JSON line for each function, with its product terms as cubes and its gates.
+} OutputFormat;
+
+// Names of the formats on the --format option, in the order of OutputFormat.
+const char *FORMAT_NAMES[] = {"text", "pla", "verilog", "json"};
+
+/**
+ * @brief Options of the minimization of the functions. Each Function gets its own copy, so that 
+ * several threads can minimize functions with different options at once (see petrick.h).
+ */
+typedef struct Options{
+  bool verbose = false;
+  // Negated terms shown in red, non-negated in green.
+  bool colored = false;
+  SolverType solver = SOLVER_SOP;
+  // Minimize all the functions together, sharing their implicants.
+  bool multipleOutputs = false;
+  // Petrick's method (sop and tree solvers) only keeps this number of the cheapest partial products 
+  // after each multiplication. All of them are kept if 0.
+  int maxProducts = 0;
+  // Petrick's method drops the partial products that already cost more than this number of operations.
+  // None are dropped if -1.
+  int costLimit = -1;
+  // Print a JSON line with the counters and the time of the stages of each function (see FunctionStats).
+  bool stats = false;
+  // Print the factored form of each result, with its gates when the subexpressions are shared (see 
+  // FactoredNetwork).
+  bool factor = false;
+  // How the results are written. The formats other than text are written by writeResults once all the
+  // functions of a group have been reduced.
+  OutputFormat format = FORMAT_TEXT;
+  // Calculate the prime implicants from the BDD of the function (see DecisionDiagram) instead of 
+  // joining its minterms and Do-Not-Care bits one by one.
+  bool bddPrimes = false;
+  // Directory where the results of the functions are stored, to be reused on later runs (see 
+  // Function::findCacheFile). No results are stored if empty.
+  string cachePath;
+  // Seconds and bytes that the minimization of each function may take (see Budget). No limit if 0.
+  double timeLimit = 0;
+  uint64_t memLimit = 0;
+
+  // @return true if the result may not be the cheapest one, so it is printed with "Optimal: yes/no".
+  bool limitsResult() const{
+    return maxProducts > 0 || costLimit >= 0 || timeLimit > 0 || memLimit > 0 || 
+           solver == SOLVER_GREEDY || solver == SOLVER_AUTO;
+  }
+}Options;
+
+/**
+ * @brief Limits of the time and the memory of the minimization of a function. The solvers check it on
+ * their loops with the bytes they are using and, once a limit is hit, they stop and return the best 
+ * cover found until then (e.g. the greedy one of BranchAndBound), which is not proven the cheapest one.
+ * 
+ * The bytes are not measured from the allocations: each solver estimates them from the number of 
+ * elements of its largest structures (the implicants of the joins, the products of Petrick's method, 
+ * the nodes of the decision diagrams...). The memory of the whole process is higher, and the memory 
+ * limit does not bound the time, e.g. of the absorptions of a sum of products that fits on it.
+ */
+typedef struct Budget{
+  double seconds = 0;
+  uint64_t bytes = 0;
+  chrono::steady_clock::time_point deadline;
+  bool exceeded = false;
+
+  Budget(){}
+
+  Budget(const Options &options) : seconds(options.timeLimit), bytes(options.memLimit){
+    deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                                                 chrono::duration<double>(seconds));
+  }
+
+  /**
+   * @param usedBytes The memory that the solver is using, or about to use.
+   * @return true if a limit has been hit, now or before.
+   */
+  bool check(uint64_t usedBytes = 0){
+    if(!exceeded) exceeded = isOver(usedBytes);
+    return exceeded;
+  }
+
+  // Same as check, but exceeded is not set, so it can be called from several threads at once.
+  bool isOver(uint64_t usedBytes = 0) const{
+    if(exceeded || (bytes > 0 && usedBytes > bytes)) return true;
+    return seconds > 0 && chrono::steady_clock::now() > deadline;
+  }
+}Budget;
+
+// Options of the command line, which the functions get when they are created.
+Options DEFAULT_OPTIONS;
+// Number of threads used to minimize the functions.
+int THREADS = 1;
+// Version of the results of the cache. It must change when the results of a function may change, e.g. 
+// with the way the operations are counted, so that the results of older versions are not used.
+const int CACHE_VERSION = 2;
+
+// Most inputs of a function. The values and masks of the cubes are stored on the narrowest type of 
+// bits that fits the inputs (see withInputBits).
+const int MAX_INPUTS = 256;
+// Most inputs of the functions whose minterms are listed, which are the ones minimized by all the 
+// solvers but espresso.
+const int MAX_EXPANDED_INPUTS = 31;
+
+/**
+ * @brief Unsigned integer of 64*Words bits, for the values and masks of the cubes of functions with 
+ * more inputs than the bits of uint64_t. It has the operators of the unsigned integers that are used 
+ * on the cubes, so the same code works with uint32_t, uint64_t and WideBits.
+ */
+template<int Words>
+struct WideBits{
+  // From the least to the most significant word.
+  uint64_t words[Words];
+
+  WideBits(uint64_t low = 0){
+    words[0] = low;
+    for(int w = 1; w < Words; w++) words[w] = 0;
+  }
+
+  explicit operator bool() const{
+    for(int w = 0; w < Words; w++){
+      if(words[w]) return true;
+    }
+    return false;
+  }
+
+  WideBits operator~() const{
+    WideBits ret;
+    for(int w = 0; w < Words; w++) ret.words[w] = ~words[w];
+    return ret;
+  }
+
+  WideBits& operator&=(const WideBits &other){
+    for(int w = 0; w < Words; w++) words[w] &= other.words[w];
+    return *this;
+  }
+  WideBits& operator|=(const WideBits &other){
+    for(int w = 0; w < Words; w++) words[w] |= other.words[w];
+    return *this;
+  }
+  WideBits& operator^=(const WideBits &other){
+    for(int w = 0; w < Words; w++) words[w] ^= other.words[w];
+    return *this;
+  }
+
+  WideBits& operator+=(const WideBits &other){
+    uint64_t carry = 0;
+    for(int w = 0; w < Words; w++){
+      uint64_t sum = words[w] + other.words[w];
+      uint64_t nextCarry = sum < words[w];
+      words[w] = sum + carry;
+      carry = nextCarry | (words[w] < sum);
+    }
+    return *this;
+  }
+  WideBits& operator-=(const WideBits &other){
+    uint64_t borrow = 0;
+    for(int w = 0; w < Words; w++){
+      uint64_t difference = words[w] - other.words[w];
+      uint64_t nextBorrow = words[w] < other.words[w];
+      nextBorrow |= difference < borrow;
+      words[w] = difference - borrow;
+      borrow = nextBorrow;
+    }
+    return *this;
+  }
+
+  WideBits& operator<<=(int shift){
+    int wordShift = shift/64, bitShift = shift%64;
+    for(int w = Words-1; w >= 0; w--){
+      uint64_t word = w >= wordShift ? words[w-wordShift] << bitShift : 0;
+      if(bitShift != 0 && w > wordShift) word |= words[w-wordShift-1] >> (64-bitShift);
+      words[w] = word;
+    }
+    return *this;
+  }
+  WideBits& operator>>=(int shift){
+    int wordShift = shift/64, bitShift = shift%64;
+    for(int w = 0; w < Words; w++){
+      uint64_t word = w+wordShift < Words ? words[w+wordShift] >> bitShift : 0;
+      if(bitShift != 0 && w+wordShift+1 < Words) word |= words[w+wordShift+1] << (64-bitShift);
+      words[w] = word;
+    }
+    return *this;
+  }
+
+  // Divides by a number of up to 32 bits and returns the remainder.
+  uint32_t divide(uint32_t divisor){
+    uint64_t remainder = 0;
+    for(int w = Words-1; w >= 0; w--){
+      unsigned __int128 dividend = ((unsigned __int128) remainder << 64) | words[w];
+      words[w] = dividend / divisor;
+      remainder = dividend % divisor;
+    }
+    return remainder;
+  }
+
+  friend WideBits operator&(WideBits a, const WideBits &b){ return a &= b; }
+  friend WideBits operator|(WideBits a, const WideBits &b){ return a |= b; }
+  friend WideBits operator^(WideBits a, const WideBits &b){ return a ^= b; }
+  friend WideBits operator+(WideBits a, const WideBits &b){ return a += b; }
+  friend WideBits operator-(WideBits a, const WideBits &b){ return a -= b; }
+  friend WideBits operator<<(WideBits a, int shift){ return a <<= shift; }
+  friend WideBits operator>>(WideBits a, int shift){ return a >>= shift; }
+  friend WideBits operator/(WideBits a, uint32_t divisor){
+    a.divide(divisor);
+    return a;
+  }
+
+  friend bool operator==(const WideBits &a, const WideBits &b){
+    for(int w = 0; w < Words; w++){
+      if(a.words[w] != b.words[w]) return false;
+    }
+    return true;
+  }
+  friend bool operator!=(const WideBits &a, const WideBits &b){ return !(a == b); }
+  friend bool operator<(const WideBits &a, const WideBits &b){
+    for(int w = Words-1; w >= 0; w--){
+      if(a.words[w] != b.words[w]) return a.words[w] < b.words[w];
+    }
+    return false;
+  }
+  friend bool operator>(const WideBits &a, const WideBits &b){ return b < a; }
+  friend bool operator<=(const WideBits &a, const WideBits &b){ return !(b < a); }
+
+  // Prints the number in decimal.
+  friend ostream& operator<<(ostream &stream, WideBits bits){
+    string digits;
+    do{
+      digits.push_back('0' + bits.divide(10));
+    }while(bits);
+    return stream << string(digits.rbegin(), digits.rend());
+  }
+};
+
+// Bits of the first numInputs inputs.
+template<typename Bits>
+Bits inputBits(int numInputs){
+  if(numInputs >= (int) (8*sizeof(Bits))) return ~Bits(0);
+  return (Bits(1) << numInputs) - Bits(1);
+}
+
+// The least significant 64 bits of the bits.
+inline uint64_t lowBits(uint32_t bits){
+  return bits;
+}
+inline uint64_t lowBits(uint64_t bits){
+  return bits;
+}
+template<int Words>
+uint64_t lowBits(const WideBits<Words> &bits){
+  return bits.words[0];
+}
+
+// Number of ones of the bits. The builtins use the popcount instruction of the processor if the 
+// compiler targets one that has it (e.g. with -march=native).
+inline int popCount(uint32_t bits){
+  return __builtin_popcount(bits);
+}
+inline int popCount(uint64_t bits){
+  return __builtin_popcountll(bits);
+}
+template<int Words>
+int popCount(const WideBits<Words> &bits){
+  int count = 0;
+  for(int w = 0; w < Words; w++) count += __builtin_popcountll(bits.words[w]);
+  return count;
+}
+
+// Hashes of the bits, used to hash the keys of the implicants (see Implicant::getKey).
+inline uint64_t hashBits(uint32_t bits){
+  return bits;
+}
+inline uint64_t hashBits(uint64_t bits){
+  return bits;
+}
+template<int Words>
+uint64_t hashBits(const WideBits<Words> &bits){
+  uint64_t hash = 0;
+  for(int w = 0; w < Words; w++){
+    hash = (hash ^ bits.words[w]) * 0x9e3779b97f4a7c15ULL;
+  }
+  return hash;
+}
+
+// Mixes the bits of x (splitmix64), so that close numbers get unrelated hashes.
+inline uint64_t mixHash(uint64_t x){
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * @brief Calls visit(Bits()) with the narrowest type of bits that fits the inputs, so that the 
+ * functions are minimized with the code instantiated for that type.
+ * 
+ * @param numInputs The number of inputs of the functions.
+ * @param visit The code to run, as a generic lambda.
+ */
+template<typename Visitor>
+void withInputBits(int numInputs, Visitor visit){
+  if(numInputs < 1 || numInputs > MAX_INPUTS){
+    throw invalid_argument("The number of inputs must be between 1 and " + to_string(MAX_INPUTS) + ".");
+  }
+  if(numInputs <= 32) visit(uint32_t());
+  else if(numInputs <= 64) visit(uint64_t());
+  else if(numInputs <= 128) visit(WideBits<2>());
+  else visit(WideBits<4>());
+}
+
+// Name of the input, from the first one: a to z, A to Z, and then the same letters followed by a 
+// number (a1, b1... Z1, a2...).
+string getInputName(int input){
+  const char *letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  string name(1, letters[input % 52]);
+  if(input >= 52) name += to_string(input / 52);
+  return name;
+}
+
+template<typename Bits>
+struct Minterm{
+  Bits val;
   bool dnc; // Do not care minterm
   int bitCount;
 
   // A minterm represents a combination of bits that produce 1 on the output of the function. 
-  Minterm(int x, bool isDNC = false) : val(x), dnc(isDNC){
-    this->bitCount = countBits(x);
+  Minterm(Bits x, bool isDNC = false) : val(x), dnc(isDNC){
+    this->bitCount = popCount(x);
   }
 
   Minterm operator^(Minterm other) const{
@@ -42,7 +418,7 @@ typedef struct Minterm{
   }
 
   Minterm operator~(){
-    return ~this->val;
+    return Minterm(~this->val);
   }
 
   bool operator<(Minterm other){
@@ -58,46 +434,43 @@ typedef struct Minterm{
     return this->val!=other.val;
   }
 
-  static int countBits(int value){
-    int bitCount = 0;
-    while(value){
-      if(value & 0x01) bitCount++;
-      value = static_cast<unsigned int>(value)>>1;
-    }
-    return bitCount;
-  }
-
-}Minterm;
-typedef vector<Minterm> Minterms;
+};
+template<typename Bits>
+using Minterms = vector<Minterm<Bits>>;
 
-typedef struct Implicant {
-  private:
-  vector<Minterm> mins;
-  
-  public:
+template<typename Bits>
+struct Implicant{
+  // An implicant is stored as a cube: the value of the bits that are common to all of its minterms
+  // and the mask of those common bits. The bits outside the mask are always zero in value, so the
+  // same group of minterms always has the same (value, mask) pair.
+  Minterm<Bits> value{Bits(0)};
   // The mask is used to 'group' the minterms. The mask is all ones, meaning that this implicant is defined
   // by all the bits of the minterms. Whenever a bit of this mask is zero, it means that said bit is not common
   // to the minterms of this implicant. For example, m(4,12)'s mask is 0111 because bit 3 is not shared between
   // 4 (0100) and 12 (1100).
-  Minterm commonBitsMask = -1;
+  Minterm<Bits> commonBitsMask{~Bits(0)};
+  // Number of bits that are not common, that is, the implicant groups 2^dashCount minterms.
+  int dashCount = 0;
+  // When several functions are minimized at once, bit i is set if this is an implicant of function i.
+  uint64_t outputs = 1;
   bool essential = true;
   // This name is used to simplify the output of Petrick Algorithm.
   char name;
 
-  Implicant(){
-    mins.clear();
-  }
+  Implicant(){}
 
-  // This is so a Minterm list can be initialized with a {1,2,3,4} for example
-  Implicant(initializer_list<Minterm> initList) {
-    mins.clear();
-    for(Minterm m : initList){
-      this->mins.push_back(m);
+  // So that a single minterm can be converted to an implicant with {m}.
+  Implicant(Minterm<Bits> m) : value(m){}
+
+  // A cube of a function of numInputs inputs, defined by the value of its common bits and its mask.
+  Implicant(Bits val, Bits mask, int numInputs) : value(val & mask), commonBitsMask(mask){
+    for(int i = 0; i < numInputs; i++){
+      if(!((mask>>i)&0x01)) dashCount++;
     }
   }
 
   int size(){
-    return mins.size();
+    return 1 << dashCount;
   }
 
   /**
@@ -109,102 +482,146 @@ typedef struct Implicant {
    * @return false If opposite.
    */
   bool joinWith(Implicant &m, Implicant &out){
-    if(this->commonBitsMask != m.commonBitsMask || this->size() != m.size()) return false;
+    if(this->commonBitsMask != m.commonBitsMask) return false;
 
-    Minterm result = (this->mins[0] & commonBitsMask)^(m.mins[0] & commonBitsMask);
+    // As the bits outside the mask are zero, the values can be directly compared.
+    Minterm<Bits> result = this->value ^ m.value;
     if(result.bitCount != 1) return false;
 
+    // The joined implicant is only an implicant of the functions of both implicants.
+    out.outputs = this->outputs & m.outputs;
+    if(out.outputs == 0) return false;
+
     // If both minterms that were joined were not essential, then set the new one as no essential.
     if(!this->essential && !m.essential) out.essential = false;
     else out.essential = true;
 
-    // Copy all the minterms of the inputs to the new implicant
-    for(int i = 0; i < this->size(); i++){ 
-      out.mins.push_back(this->mins[i]);
-      out.mins.push_back(m.mins[i]);
-    }
-    // Sort the minterms
-    out.sort();
-
     // Set the new mask as the combination of the common bit in result and the original mask.
     out.commonBitsMask = this->commonBitsMask&(~result);
+    out.value = this->value & out.commonBitsMask;
+    out.dashCount = this->dashCount + 1;
     return true;
   }
 
-  // Insertion sort.
-  void sort(){
-    int n = mins.size();
-    for (int i = 1; i < n; ++i) {
-      int key = mins[i].val;
-      int j = i - 1;
-      while (j >= 0 && mins[j].val > key) {
-        mins[j + 1] = mins[j];
-        j = j - 1;
-      }
-      mins[j + 1] = key;
+  // @return true if the minterm m is one of the minterms of this implicant.
+  bool covers(Minterm<Bits> m){
+    return (m.val & commonBitsMask.val) == value.val;
+  }
+
+  // Returns the minterm on position index, with the minterms sorted from lower to greater. The bits
+  // of index are placed on the bits that are not common to the implicant.
+  Minterm<Bits> operator[](int index){
+    if(index == 0) return value;
+
+    Bits val = value.val;
+    for(int bit = 0; index != 0; bit++){
+      if((commonBitsMask.val>>bit)&0x01) continue;
+      if(index&0x01) val |= Bits(1)<<bit;
+      index >>= 1;
     }
+    return Minterm<Bits>(val);
+  }
+
+  // Calls visit(m) with the value m of each minterm of the implicant, from lower to greater.
+  template<typename Visitor>
+  void forEachMinterm(Visitor visit){
+    // The bits outside the inputs are set on the mask, so only the inputs can be dashes.
+    Bits dashes = ~commonBitsMask.val;
+    Bits offset = 0;
+    do{
+      visit(value.val | offset);
+      // Next combination of the dash bits.
+      offset = (offset - dashes) & dashes;
+    }while(offset);
   }
 
-  Minterm& operator[](int index){
-    return mins[index];
+  // Expands the implicant to all its minterms, sorted from lower to greater.
+  Minterms<Bits> getMinterms(){
+    Minterms<Bits> ret;
+    for(int i = 0; i < size(); i++){
+      ret.push_back((*this)[i]);
+    }
+    return ret;
   }
 
   bool operator==(Implicant imp){
-    if(this->size() != imp.size()) return false;
-    for(Minterm m1 : this->mins){
-      bool foundPair = false;
-      for(Minterm m2 : imp.mins){
-        foundPair = m1.val == m2.val;
-        if(foundPair) break;
-      }
-      if(!foundPair) return false;
+    return this->commonBitsMask == imp.commonBitsMask && this->value == imp.value;
+  }
+
+  // Unique key of the (value, mask) pair of this implicant, so that implicants can be hashed.
+  typedef pair<Bits, Bits> Key;
+  typedef struct KeyHash{
+    size_t operator()(const Key &key) const{
+      uint64_t maskHash = hashBits(key.first);
+      return ((maskHash << 32) | (maskHash >> 32)) ^ hashBits(key.second);
     }
-    return true;
+  }KeyHash;
+  typedef unordered_set<Key, KeyHash> KeySet;
+
+  Key getKey() const{
+    return Key(commonBitsMask.val, value.val);
   }
 
-  void print(){
-    cout << name;
+  void print(ostream &stream){
+    stream << name;
   }
 
-  void printDetailed(){
-    cout << name <<  " = m(";
-    for(int i = 0; i < mins.size(); i++){
-      cout << mins[i].val;
-      if(i != mins.size()-1) cout << ",";
+  void printDetailed(ostream &stream){
+    stream << name <<  " = m(";
+    Minterms<Bits> mins = getMinterms();
+    for(size_t i = 0; i < mins.size(); i++){
+      stream << mins[i].val;
+      if(i != mins.size()-1) stream << ",";
     }
-    cout << ") Mask: " << (~commonBitsMask).val;
+    stream << ") Mask: " << (~commonBitsMask).val;
     if(this->essential){
-      cout << " Essential";
+      stream << " Essential";
     }
   }
 
-  void printAlgebraic(int functionBitSize){
-    char out = 'a';
+  void printAlgebraic(ostream &stream, int functionBitSize, bool colored){
+    // Without common bits the implicant is the constant 1.
+    if(getLiterals(functionBitSize).empty()){
+      stream << "1";
+      return;
+    }
+    int input = 0;
     functionBitSize--;
     for(;functionBitSize >= 0; functionBitSize--){
+      string out = getInputName(input++);
       if((commonBitsMask.val>>functionBitSize)&0x01){
-        if((mins[0].val>>functionBitSize)&0x01){
-          if(COLORED){
-            cout << "\e[0;32m";
-            cout << out;
-            cout << "\e[0m";
+        if((value.val>>functionBitSize)&0x01){
+          if(colored){
+            stream << "\e[0;32m";
+            stream << out;
+            stream << "\e[0m";
           }else{
-            cout << out;
+            stream << out;
           }
         }else{
-          if(COLORED){
-            cout << "\e[0;31m";
-            cout << out;
-            cout << "\e[0m";
+          if(colored){
+            stream << "\e[0;31m";
+            stream << out;
+            stream << "\e[0m";
           }else{
-            cout << "#" << out;
+            stream << "#" << out;
           }
         }
       }
-      out++;
     }
   }
 
+  // Literals of the implicant from the first input: 2*input if the input is 1 or 2*input+1 if it is
+  // negated (see FactoredNetwork).
+  vector<int> getLiterals(int functionBitSize){
+    vector<int> ret;
+    for(int input = 0; input < functionBitSize; input++){
+      int bit = functionBitSize-1-input;
+      if((commonBitsMask.val>>bit)&0x01) ret.push_back(2*input + ((value.val>>bit)&0x01 ? 0 : 1));
+    }
+    return ret;
+  }
+
   // Number of logic gates or operations that are needed to define this implicant.
   int getOperationCount(int functionBitSize, int* andCount, int* notCount){
     // Start on -1: if there are three members being multiplied, we will do two multiplications.
@@ -217,19 +634,130 @@ typedef struct Implicant {
         opCount++; // Multiplication gate.
         (*andCount)++;
 
-        if(!((mins[0].val>>i)&0x01)){
+        if(!((value.val>>i)&0x01)){
           // The value is negated, we need to add a NOT gate.
           opCount++;
           (*notCount)++;
         }
       }
     }
+    // Without common bits the implicant is the constant 1, which needs no gates.
+    if(opCount == -1){
+      (*andCount)++;
+      return 0;
+    }
     return opCount;
   }
 
-}Implicant;
+};
+
+template<typename Bits>
+using Implicants = vector<Implicant<Bits>>;
+
+// Implicants of the same mask and number of ones, with their values stored one after the other so that
+// they can be compared by blocks (see findAdjacentValues).
+template<typename Bits>
+struct ImplicantBucket{
+  vector<int> indexes;
+  vector<Bits> values;
+};
+
+// Part of the implicants of a bucket (the ones on positions [begin, end) of lower) that are joined with 
+// the implicants of the next bucket (upper).
+template<typename Bits>
+struct BucketPair{
+  ImplicantBucket<Bits> *lower;
+  ImplicantBucket<Bits> *upper;
+  int begin;
+  int end;
+};
+
+/**
+ * @brief Finds the candidates that differ from value on a single bit, which are the ones that can be 
+ * joined with it. This is the innermost loop of the joins of the implicants.
+ * 
+ * @param value The value to compare.
+ * @param candidates The values of the candidates.
+ * @param count The number of candidates.
+ * @param matches Gets the positions of the candidates that differ on a single bit, in order.
+ * @return int The number of candidates that differ on a single bit.
+ */
+template<typename Bits>
+int findAdjacentValues(const Bits &value, const Bits *candidates, int count, int *matches){
+  int matchCount = 0;
+  for(int k = 0; k < count; k++){
+    if(popCount(value ^ candidates[k]) == 1) matches[matchCount++] = k;
+  }
+  return matchCount;
+}
+
+// The implicants are only joined on functions of up to MAX_EXPANDED_INPUTS inputs, so their values 
+// are always of uint32_t. The candidates are compared by blocks of 16 (AVX-512), 8 (AVX2) or 4 (NEON)
+// with the vector instructions the compiler targets, and the rest one by one: x = value ^ candidate 
+// has a single bit if x != 0 and x & (x-1) == 0.
+inline int findAdjacentValues(const uint32_t &value, const uint32_t *candidates, int count, int *matches){
+  int matchCount = 0, k = 0;
+#if defined(__AVX512F__)
+  const __m512i values512 = _mm512_set1_epi32(value);
+  const __m512i ones512 = _mm512_set1_epi32(1);
+  for(; k+16 <= count; k += 16){
+    __m512i x = _mm512_xor_si512(values512, _mm512_loadu_si512(candidates+k));
+    __m512i lowestCleared = _mm512_and_si512(x, _mm512_sub_epi32(x, ones512));
+    unsigned int single = _mm512_test_epi32_mask(x, x) & _mm512_testn_epi32_mask(lowestCleared, lowestCleared);
+    for(; single != 0; single &= single-1){
+      matches[matchCount++] = k + __builtin_ctz(single);
+    }
+  }
+#endif
+#if defined(__AVX2__)
+  const __m256i values256 = _mm256_set1_epi32(value);
+  const __m256i ones256 = _mm256_set1_epi32(1);
+  const __m256i zero256 = _mm256_setzero_si256();
+  for(; k+8 <= count; k += 8){
+    __m256i x = _mm256_xor_si256(values256, _mm256_loadu_si256((const __m256i*) (candidates+k)));
+    __m256i lowestCleared = _mm256_and_si256(x, _mm256_sub_epi32(x, ones256));
+    __m256i isSingle = _mm256_andnot_si256(_mm256_cmpeq_epi32(x, zero256), 
+                                           _mm256_cmpeq_epi32(lowestCleared, zero256));
+    unsigned int single = _mm256_movemask_ps(_mm256_castsi256_ps(isSingle));
+    for(; single != 0; single &= single-1){
+      matches[matchCount++] = k + __builtin_ctz(single);
+    }
+  }
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+  const uint32x4_t values128 = vdupq_n_u32(value);
+  const uint32x4_t ones128 = vdupq_n_u32(1);
+  const uint32x4_t laneBits = {1, 2, 4, 8};
+  for(; k+4 <= count; k += 4){
+    uint32x4_t x = veorq_u32(values128, vld1q_u32(candidates+k));
+    uint32x4_t lowestCleared = vandq_u32(x, vsubq_u32(x, ones128));
+    uint32x4_t isSingle = vandq_u32(vtstq_u32(x, x), vceqzq_u32(lowestCleared));
+    unsigned int single = vaddvq_u32(vandq_u32(isSingle, laneBits));
+    for(; single != 0; single &= single-1){
+      matches[matchCount++] = k + __builtin_ctz(single);
+    }
+  }
+#endif
+  for(; k < count; k++){
+    if(popCount(value ^ candidates[k]) == 1) matches[matchCount++] = k;
+  }
+  return matchCount;
+}
+
+// Result of joining the implicants on positions first and second of a list of implicants.
+template<typename Bits>
+struct ImplicantJoin{
+  int first;
+  int second;
+  Implicant<Bits> result;
 
-typedef vector<Implicant> Implicants;
+  ImplicantJoin(int f, int s) : first(f), second(s){}
+
+  bool operator<(const ImplicantJoin &other) const{
+    if(first != other.first) return first < other.first;
+    return second < other.second;
+  }
+};
 
 typedef enum OperationType{
   IMPLICANT_SUM,
@@ -239,36 +767,134 @@ typedef enum OperationType{
 /**
  * @brief An ImplicantOperation represents a sum or multiplication of implicants.
  */
-typedef struct ImplicantOperation{
+template<typename Bits>
+struct ImplicantOperation{
   // If this is a simple ImplicantOperation, it will reference to a single implicants object. 
-  Implicant* imp = 0;
+  Implicant<Bits>* imp = 0;
+
+  // The operators are allocated from the memory resource of this allocator, which is passed on to the
+  // copies of the operation and to all the operations built from it. This way, a whole expansion of 
+  // Petrick's method can live in a single arena that is freed at once (see Function::petrickTree).
+  typedef pmr::polymorphic_allocator<ImplicantOperation> allocator_type;
 
   // Stores all the implicants (stored as ImplicantOperation-s) that are being multiplied.
-  vector<ImplicantOperation> operators;
+  pmr::vector<ImplicantOperation> operators;
   // Type of operation. By default it will be a multiplication.
   OperationType type = IMPLICANT_MULT;
+  // Hash of the implicants of the operation, which doesn't depend on the order of its operators. Two 
+  // equal operations always have the same hash.
+  uint64_t hash = 0;
+  // If this is a single implicant or a multiplication of single implicants (a product). The implicants
+  // of a product are sorted by address (that is, by their index on the list of implicants of the 
+  // function) and not repeated.
+  bool product = false;
+  // For products, a bit for each of its implicants (some may share the same bit). The implicants of a
+  // product can only be inside another one if its bits are also set on the other.
+  uint64_t signature = 0;
+
+  ImplicantOperation(const allocator_type &alloc = allocator_type()) : operators(alloc) {
+    updateHash();
+  }
+  ImplicantOperation(Implicant<Bits>* imps, const allocator_type &alloc = allocator_type()) : imp(imps), operators(alloc){
+    updateHash();
+  }
 
-  ImplicantOperation() {}
-  ImplicantOperation(Implicant* imps) : imp(imps){}
+  // The copies keep the allocator of the original, unless they are placed inside a container with another.
+  ImplicantOperation(const ImplicantOperation &other) : 
+      ImplicantOperation(other, other.get_allocator()){}
+  ImplicantOperation(const ImplicantOperation &other, const allocator_type &alloc) : 
+      imp(other.imp), operators(other.operators, alloc), type(other.type), hash(other.hash), 
+      product(other.product), signature(other.signature){}
+  ImplicantOperation(ImplicantOperation &&other) = default;
+  ImplicantOperation(ImplicantOperation &&other, const allocator_type &alloc) : 
+      imp(other.imp), operators(move(other.operators), alloc), type(other.type), hash(other.hash),
+      product(other.product), signature(other.signature){}
+  ImplicantOperation& operator=(const ImplicantOperation &other) = default;
+  ImplicantOperation& operator=(ImplicantOperation &&other) = default;
+
+  allocator_type get_allocator() const{
+    return operators.get_allocator();
+  }
 
 private:
-  void levelParenthesis(vector<ImplicantOperation> &previousList, OperationType operationLevel){
+  // Moves the operations of this one that are not of type operationLevel to the end of list.
+  void moveLevel(pmr::vector<ImplicantOperation> &list, OperationType operationLevel){
     if(type != operationLevel || imp!=0){
-      previousList.push_back(*this);
+      list.push_back(move(*this));
     }else{
-      for(ImplicantOperation i : operators){
-          i.levelParenthesis(previousList, operationLevel);
+      for(ImplicantOperation &i : operators){
+          i.moveLevel(list, operationLevel);
       }
     }
   }
 
+  bool isEmpty() const{
+    return imp==0 && operators.size()==0;
+  }
+
+  // Recalculates the hash, product and signature after changing the operators. The hashes of the 
+  // operators are added, so that their order doesn't change the hash.
+  void updateHash(){
+    if(imp){
+      hash = mixHash(reinterpret_cast<uintptr_t>(imp));
+      product = true;
+      signature = 1ULL << (hash % 64);
+      return;
+    }
+    hash = type;
+    product = type == IMPLICANT_MULT;
+    signature = 0;
+    for(const ImplicantOperation &op : operators){
+      hash += mixHash(op.hash);
+      product = product && op.imp;
+      signature |= op.signature;
+    }
+  }
+
+  // Implicants of a product, the one of a single implicant or the ones of its operators.
+  const ImplicantOperation* productBegin() const{
+    return imp ? this : operators.data();
+  }
+  const ImplicantOperation* productEnd() const{
+    return imp ? this+1 : operators.data() + operators.size();
+  }
+
+  static bool lessImplicant(const ImplicantOperation &a, const ImplicantOperation &b){
+    return less<Implicant<Bits>*>()(a.imp, b.imp);
+  }
+
 public:
+  /**
+   * @brief The product of a list of implicants, as multiplying them one by one would give, but built
+   * at once, so that large covers don't have to copy the product on each multiplication.
+   * 
+   * @param imps The implicants of the product.
+   * @return ImplicantOperation Their product, sorted and without repeating them.
+   */
+  static ImplicantOperation productOf(const vector<Implicant<Bits>*> &imps){
+    ImplicantOperation ret;
+    for(Implicant<Bits> *i : imps){
+      ret.operators.emplace_back(i);
+    }
+    sort(ret.operators.begin(), ret.operators.end(), lessImplicant);
+    auto sameImplicant = [](const ImplicantOperation &a, const ImplicantOperation &b){ return a.imp == b.imp; };
+    ret.operators.erase(unique(ret.operators.begin(), ret.operators.end(), sameImplicant), ret.operators.end());
+    // A single implicant is not a multiplication (X * X = X).
+    if(ret.operators.size() == 1) return ImplicantOperation(ret.operators[0].imp);
+    ret.updateHash();
+    return ret;
+  }
+
   // Puts the function on the same level of parenthesis.
   // [m(0,1)+[m(0,1)*m(1,5)]]+[[m(0,2)*m(0,1)]+[m(0,2)*m(1,5)]] => [ m(0,1) + [m(0,1)*m(1,5)] + [m(0,2)*m(0,1)] + [m(0,2)*m(1,5)] ]
   void levelParenthesis(){
-    vector<ImplicantOperation> tempList;
-    levelParenthesis(tempList, type);
-    operators = tempList;
+    if(imp!=0) return;
+    pmr::vector<ImplicantOperation> tempList(get_allocator());
+    for(ImplicantOperation &i : operators){
+      i.moveLevel(tempList, type);
+    }
+    operators = move(tempList);
+    updateHash();
   }
 
   /**
@@ -279,95 +905,175 @@ public:
   bool applySumAbsortion(){
     if(type != IMPLICANT_SUM) return false;
 
+    // Remove the repeated terms, which are found by their hashes (keeping the first one).
     bool anyChange = false;
+    unordered_multimap<uint64_t, int> termsByHash;
+    size_t termCount = 0;
+    for(size_t i = 0; i < operators.size(); i++){
+      auto range = termsByHash.equal_range(operators[i].hash);
+      bool repeated = false;
+      for(auto term = range.first; term != range.second && !repeated; term++){
+        repeated = operators[term->second] == operators[i];
+      }
+      if(repeated) continue;
+      termsByHash.emplace(operators[i].hash, termCount);
+      if(i != termCount) operators[termCount] = move(operators[i]);
+      termCount++;
+    }
+    operators.erase(operators.begin() + termCount, operators.end());
+
     for(auto it = operators.begin(); it != operators.end(); it++){
-      ImplicantOperation op1 = *it;
+      const ImplicantOperation &op1 = *it;
       for(auto start = it+1; start!=operators.end();){
-        ImplicantOperation op2 = *start;
+        const ImplicantOperation &op2 = *start;
         // Search op1 inside op2.
         if(op2.searchImplicant(op1)){
-          operators.erase(start);
+          start = operators.erase(start);
           // anyChange = true; // No need to check again, as the object to the right is the one being removed and it does not need to be later checked.
         // Search op2 inside op1.
         }else if(op1.searchImplicant(op2)){
-          // If it is found, we switch the implicants so op1 is now op2.
+          // If it is found, op2 takes the place of op1, and the rest of terms are compared with it. The 
+          // terms that were already compared with op1 may contain op2, so another pass is needed.
           // Suppose AB, B, A, AC, C. When comparing AB(op1) with A(op2), A is in AB, so switch the values and erase the latter one.
           // As A is greater in scope than AB, I should group all AB groups and more. 
-          iter_swap(it,start);
-          operators.erase(start);
+          *it = move(*start);
+          start = operators.erase(start);
           anyChange = true;
         }else{
           start++;
         }
       }
     }
+    updateHash();
     return anyChange;
   }
 
-  ImplicantOperation operator+(ImplicantOperation other){
-    // This is an empty variable.
-    if(imp==0 && operators.size()==0) return other;
-
-    // cout << "\e[0;34m";
-    // this->print();
-    // cout << "+";
-    // other.print();
-    // cout << "\e[0m" << endl;
-
-    // Fastly apply X + X = X.
-    if(*this == other) return other;
+  // Sums other to this operation, in place.
+  ImplicantOperation& operator+=(ImplicantOperation other){
+    // This is an empty variable. Fastly apply X + X = X.
+    if(isEmpty() || *this == other){
+      *this = move(other);
+      return *this;
+    }
 
     // Normal sum (do not apply distributive property).
-    ImplicantOperation ret;
-    ret.type = IMPLICANT_SUM;
-    ret.operators.push_back(*this);
-    ret.operators.push_back(other);
-    return ret;
+    ImplicantOperation left(move(*this));
+    imp = 0;
+    type = IMPLICANT_SUM;
+    operators.clear();
+    operators.reserve(2);
+    operators.push_back(move(left));
+    operators.push_back(move(other));
+    updateHash();
+    return *this;
   }
 
-  ImplicantOperation operator*(ImplicantOperation other){
-    // This is an empty variable.
-    if(imp==0 && operators.size()==0) return other;
-
-    // cout << "\e[0;34m";
-    // this->print();
-    // cout << "*";
-    // other.print();
-    // cout << "\e[0m" << endl;
+  // Multiplies this operation by other, in place.
+  ImplicantOperation& operator*=(const ImplicantOperation &other){
+    // This is an empty variable. Fastly apply X * X = X.
+    if(isEmpty() || *this == other){
+      *this = other;
+      return *this;
+    }
 
-    // Fastly apply X * X = X.
-    if(*this == other) return other;
-    
     // Distributive property X * (X + Y) = XX + XY = X + XY
-    ImplicantOperation a = *this, b = other;
-    if(a.type == IMPLICANT_SUM){
-      ImplicantOperation sum;
-      for(ImplicantOperation op : a.operators){
-        sum = sum + (b*op); // Recursive
+    if(type == IMPLICANT_SUM){
+      ImplicantOperation sum(get_allocator());
+      for(const ImplicantOperation &op : operators){
+        sum += other*op; // Recursive
       }
-      return sum;
+      *this = move(sum);
+      return *this;
     }
-    if(b.type == IMPLICANT_SUM){
-      ImplicantOperation sum;
-      for(ImplicantOperation op : b.operators){
-        sum = sum + (a*op); // Recursive
+    if(other.type == IMPLICANT_SUM){
+      ImplicantOperation sum(get_allocator());
+      for(const ImplicantOperation &op : other.operators){
+        sum += (*this)*op; // Recursive
       }
-      return sum;
+      *this = move(sum);
+      return *this;
     }
 
     // Apply idempotent law X * XY = XY
-    if(a.searchImplicant(b)){
-      return a;
+    if(searchImplicant(other)){
+      return *this;
     }
-    if(b.searchImplicant(a)){
-      return b;
+    if(other.searchImplicant(*this)){
+      *this = other;
+      return *this;
     }
 
-    ImplicantOperation ret;
-    ret.type = IMPLICANT_MULT;
-    ret.operators.push_back(*this);
-    ret.operators.push_back(other);
-    ret.levelParenthesis();
+    // Put the operands of both multiplications on the same level, sorted and without repeating them
+    // (X * X = X).
+    pmr::vector<ImplicantOperation> factors(get_allocator());
+    moveLevel(factors, IMPLICANT_MULT);
+    ImplicantOperation(other, get_allocator()).moveLevel(factors, IMPLICANT_MULT);
+    imp = 0;
+    type = IMPLICANT_MULT;
+    operators = move(factors);
+    updateHash();
+    if(product){
+      sort(operators.begin(), operators.end(), lessImplicant);
+      auto sameImplicant = [](const ImplicantOperation &a, const ImplicantOperation &b){ return a.imp == b.imp; };
+      operators.erase(unique(operators.begin(), operators.end(), sameImplicant), operators.end());
+    }
+    updateHash();
+    return *this;
+  }
+
+  /**
+   * @brief Removes the most expensive terms of a sum, keeping at least the cheapest one. The cost of a
+   * term is a lower bound of the cost of the terms that come from multiplying it.
+   * 
+   * @param functionBitSize Number of inputs of the function.
+   * @param maxTerms Number of terms that are kept, or 0 to keep all of them.
+   * @param costLimit Terms whose cost is greater are removed. None if -1.
+   * @return int The lowest cost of the removed terms, or INT_MAX if none was removed.
+   */
+  int pruneTerms(int functionBitSize, int maxTerms, int costLimit){
+    if(type != IMPLICANT_SUM || imp) return INT_MAX;
+
+    int termCount = operators.size();
+    vector<int> costs(termCount);
+    vector<int> order(termCount);
+    for(int i = 0; i < termCount; i++){
+      int andCount, orCount, notCount;
+      costs[i] = operators[i].getOperationCount(functionBitSize, &andCount, &orCount, &notCount);
+      order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b){ return costs[a] < costs[b]; });
+
+    int keptCount = maxTerms > 0 ? min(maxTerms, termCount) : termCount;
+    if(costLimit >= 0){
+      while(keptCount > 1 && costs[order[keptCount-1]] > costLimit) keptCount--;
+    }
+    if(keptCount == termCount) return INT_MAX;
+
+    // Remove the rest without changing the order of the terms that are kept.
+    vector<bool> removed(termCount, false);
+    for(int i = keptCount; i < termCount; i++){
+      removed[order[i]] = true;
+    }
+    int newSize = 0;
+    for(int i = 0; i < termCount; i++){
+      if(removed[i]) continue;
+      if(newSize != i) operators[newSize] = move(operators[i]);
+      newSize++;
+    }
+    operators.erase(operators.begin() + newSize, operators.end());
+    updateHash();
+    return costs[order[keptCount]];
+  }
+
+  ImplicantOperation operator+(const ImplicantOperation &other) const{
+    ImplicantOperation ret(*this);
+    ret += other;
+    return ret;
+  }
+
+  ImplicantOperation operator*(const ImplicantOperation &other) const{
+    ImplicantOperation ret(*this);
+    ret *= other;
     return ret;
   }
 
@@ -377,7 +1083,14 @@ public:
    * @param other The ImplicantOperation to look for.
    * @return true if other is contained inside this. false otherwise.
    */
-  bool searchImplicant(ImplicantOperation other){
+  bool searchImplicant(const ImplicantOperation &other) const{
+    // The implicants of two products are sorted, so they can be compared in a single pass.
+    if(product && other.product){
+      if(type != other.type || (other.signature & ~signature) != 0) return false;
+      if(other.productEnd() - other.productBegin() > productEnd() - productBegin()) return false;
+      return includes(productBegin(), productEnd(), other.productBegin(), other.productEnd(), lessImplicant);
+    }
+
     // Must be same type (+/*) of operation. Other cannot have a number of implicants greater than this (ABC in A?, of course not)
     if(this->type!=other.type || other.operators.size() > this->operators.size()) return false;
 
@@ -388,14 +1101,14 @@ public:
 
     // If it is a minterm...
     if(other.imp){
-      for(ImplicantOperation imp2 : operators){
+      for(const ImplicantOperation &imp2 : operators){
         if(other.imp == imp2.imp) return true;
       }
       return false;
     }else{
-      for(ImplicantOperation imp1 : other.operators){
+      for(const ImplicantOperation &imp1 : other.operators){
         bool found = false;
-        for(ImplicantOperation imp2 : operators){
+        for(const ImplicantOperation &imp2 : operators){
           if(imp1 == imp2){ // Recursion.
             found = true;
             break;
@@ -407,7 +1120,13 @@ public:
     return true;
   }
 
-  bool operator==(ImplicantOperation other){
+  bool operator==(const ImplicantOperation &other) const{
+    if(hash != other.hash) return false;
+    if(product && other.product){
+      return equal(productBegin(), productEnd(), other.productBegin(), other.productEnd(), 
+                   [](const ImplicantOperation &a, const ImplicantOperation &b){ return a.imp == b.imp; });
+    }
+
     // Must be same type (+/*) of operation and same size.
     if(this->type!=other.type || this->operators.size()!=other.operators.size()) return false;
 
@@ -418,9 +1137,9 @@ public:
 
     if(operators.size() != other.operators.size()) return false;
 
-    for(ImplicantOperation imp1 : operators){
+    for(const ImplicantOperation &imp1 : operators){
       bool found = false;
-      for(ImplicantOperation imp2 : other.operators){
+      for(const ImplicantOperation &imp2 : other.operators){
         if(imp1 == imp2){ // Recursion.
           found = true;
           break;
@@ -431,7 +1150,7 @@ public:
     return true;
   }
 
-  bool operator!=(ImplicantOperation other){
+  bool operator!=(const ImplicantOperation &other) const{
     return !((*this)==other);
   }
 
@@ -440,7 +1159,7 @@ public:
       int opers = operators.size() - 1; // Number of OR operations.
       (*orCount) += opers;
 
-      for(ImplicantOperation ops : operators){
+      for(ImplicantOperation &ops : operators){
         opers += ops.getOperationCount__(functionBitSize, andCount, orCount, notCount); // Number of AND and NOT operations.
       }
       return opers;
@@ -456,354 +1175,4141 @@ public:
     return getOperationCount__(functionBitSize, andCount, orCount, notCount);
   }
 
-  void print(){
-    if(!VERBOSE) return;
-
+  void print(ostream &stream){
     if(imp){
-      imp->print();
+      imp->print(stream);
     }else{
-      cout << "[";
-      for(int i = 0; i < operators.size(); i++){
-        operators[i].print();
+      stream << "[";
+      for(size_t i = 0; i < operators.size(); i++){
+        operators[i].print(stream);
         if(i != operators.size()-1){
-          if(type == IMPLICANT_SUM) cout << "+";
-          else if(type == IMPLICANT_MULT) cout << "*";
+          if(type == IMPLICANT_SUM) stream << "+";
+          else if(type == IMPLICANT_MULT) stream << "*";
         }
       }
-      cout << "]";
+      stream << "]";
     }
   }
 
-  void printAlgebraic(int functionBitSize){
+  void printAlgebraic(ostream &stream, int functionBitSize, bool colored){
     if(imp){
-      imp->printAlgebraic(functionBitSize);
+      imp->printAlgebraic(stream, functionBitSize, colored);
     }else{
-      cout << "[";
-      for(int i = 0; i < operators.size(); i++){
-        operators[i].printAlgebraic(functionBitSize);
+      stream << "[";
+      for(size_t i = 0; i < operators.size(); i++){
+        operators[i].printAlgebraic(stream, functionBitSize, colored);
         if(i != operators.size()-1){
           // When passing from an ImplicantOperation to minterms, the operations are reversed.
           // Normally one single ImplicantOperation is to be output.
-          if(type == IMPLICANT_SUM) cout << "*";
-          else if(type == IMPLICANT_MULT) cout << "+";
+          if(type == IMPLICANT_SUM) stream << "*";
+          else if(type == IMPLICANT_MULT) stream << "+";
         }
       }
-      cout << "]";
+      stream << "]";
     }
   }
-}ImplicantOperation;
+};
 
-typedef struct Function{
-  Implicants originalFunction;
-  Implicants imps;
-  // Number of inputs
-  int numInputs;
-  string funcName;
-  
-  Function(Minterms m, Minterms dnc, int nInp, string name) : numInputs(nInp), funcName(name){
-    // Put both minterms inside the implicant function as separate implicants but in order.
-    int mIndex = 0, dIndex = 0;
-    while(mIndex != m.size() || dIndex != dnc.size()){
-      Implicant tempImp;
-      if(mIndex == m.size()){
-        dnc[dIndex].dnc = true;
-        tempImp = {dnc[dIndex++]};
-        tempImp.essential = false;
-      }else if(dIndex == dnc.size()){
-        tempImp = {m[mIndex++]};
-      }else if(m[mIndex] < dnc[dIndex]){
-        tempImp = {m[mIndex++]};
-      }else if(m[mIndex] > dnc[dIndex]){
-        dnc[dIndex].dnc = true;
-        tempImp = {dnc[dIndex++]};
-        tempImp.essential = false;
-      }else{
-        throw invalid_argument("Input of two minterms as Do not care and Do care");
-      }
-      originalFunction.push_back(tempImp);
-    }
+/**
+ * @brief A sum of products of implicants, used to expand the product of sums of Petrick's method.
+ * Each product is stored as a bitset over the implicants of the function (bit i is set if the 
+ * implicant i is being multiplied), and all the products are stored one after the other in a single
+ * array of words. This way, X + XY = X is a subset test on words.
+ */
+typedef struct SumOfProducts{
+  // Number of words of each product.
+  int productWords;
+  // The words of all the products.
+  vector<uint64_t> words;
+  // Most products there have been at once (before removing the absorbed ones), passes of
+  // applySumAbsortion and bytes allocated for the products, for FunctionStats.
+  int peakSize = 1;
+  int absorptionPasses = 0;
+  uint64_t allocatedBytes = 0;
+  // If not null, the absorptions stop once it is exceeded, which leaves some products that are absorbed
+  // by others but keeps the same sum.
+  Budget *budget = 0;
+
+  // Starts as the empty product, which is 1 (the neutral element of the multiplication).
+  SumOfProducts(int implicantCount) : productWords((implicantCount+63)/64){
+    if(productWords == 0) productWords = 1;
+    words.resize(productWords, 0);
   }
 
-  void reduce(){
-    calculateImplicants();
-    removeNonEssentialImplicants();
-    if(VERBOSE){
-      nameImplicants();
-    }
-    petrick();
+  int size(){
+    return words.size()/productWords;
   }
 
-  void printTruthTable(){
-      for(int i = 0; i < numInputs; i++){
-          cout << (char)('a'+i);
-      }
-      cout << "  " << funcName << endl;
+  uint64_t* operator[](int index){
+    return &words[index*productWords];
+  }
 
-      for(int i = 0; i < (1<<numInputs); i++){
-          for(int j = numInputs-1; j >= 0; j--){
-              if(i&(1<<j)){
-                  cout << '1';
-              }else{
-                  cout << '0';
-              }
-          }
+  /**
+   * @brief Multiplies this sum of products by a sum of implicants. Uses the distributive property and 
+   * then applies X + XY = X and X + X = X.
+   * 
+   * @param sum Indexes of the implicants being summed.
+   */
+  void multiply(vector<int> &sum){
+    vector<uint64_t> result;
+    result.reserve(words.size()*sum.size());
+    for(int i = 0; i < size(); i++){
+      uint64_t* product = (*this)[i];
 
-          cout << "  ";
-          int search = searchMinterm(i);
-          if(search == 0){
-              cout << '1';
-          }else if(search == 1){
-              cout << 'x';
-          }else{
-              cout << '0';
-          }
-          cout << endl;
+      // X * (X + Y) = X + XY = X
+      bool containsImplicant = false;
+      for(int imp : sum){
+        if(product[imp>>6] & (1ULL<<(imp&63))){
+          containsImplicant = true;
+          break;
+        }
+      }
+      if(containsImplicant){
+        result.insert(result.end(), product, product+productWords);
+        continue;
       }
-  }
 
-  private:
-  void petrick(){
-    // Convert implicants to operations.
-    ImplicantOperation ops[imps.size()];
-    for(int i = 0; i < imps.size(); i++){
-      ImplicantOperation op(&imps[i]);
-      ops[i] = op;
+      for(int imp : sum){
+        result.insert(result.end(), product, product+productWords);
+        result[result.size()-productWords+(imp>>6)] |= 1ULL<<(imp&63);
+      }
     }
+    peakSize = max<int>(peakSize, result.size()/productWords);
+    allocatedBytes += result.capacity()*sizeof(uint64_t);
+    words.swap(result);
+    applySumAbsortion();
+  }
 
-    ImplicantOperation result;
-    bool resultValueSet = false;
-    // From the prime implicant chart, we shall group the implicants that share the same minterm value.
-    ImplicantOperation mult;
-    for(Implicant i : originalFunction){
-      Minterm min = i[0];
-      if(min.dnc) continue;  // If it is a DNC, no need to add it.
+  // Applies X + XY = X and X + X = X. The order of the remaining products is kept.
+  void applySumAbsortion(){
+    absorptionPasses++;
+    int productCount = size();
+    vector<int> bitCounts(productCount);
+    vector<int> order(productCount);
+    for(int i = 0; i < productCount; i++){
+      bitCounts[i] = countImplicants(i);
+      order[i] = i;
+    }
+    // The products with less implicants can only absorb the ones with more implicants.
+    stable_sort(order.begin(), order.end(), [&](int a, int b){ return bitCounts[a] < bitCounts[b]; });
 
-      ImplicantOperation sum;
-      // All implicants...
-      for(ImplicantOperation op : ops){
-        Implicant imp = *op.imp;
-        // Minterms of this implicant...
-        for(int i = 0; i < imp.size(); i++){
-          // If the implicant contains the minterm.
-          if(imp[i] == min){
-            sum = sum + op;
-            break;
-          }
+    vector<int> kept;
+    vector<bool> absorbed(productCount, false);
+    for(int i : order){
+      if(budget && budget->check()) break;
+      for(int k : kept){
+        if(isSubset((*this)[k], (*this)[i])){
+          absorbed[i] = true;
+          break;
         }
       }
-      sum.print();
-      mult = mult * sum;
-      if(VERBOSE){
-        cout<<endl;
-        mult.print();
-        cout<<endl<<"****************"<<endl;
-      }
-      mult.levelParenthesis();
-      // Simplify till no changes are made.
-      while(mult.applySumAbsortion()){}
+      if(!absorbed[i]) kept.push_back(i);
     }
 
-    if(VERBOSE){
-      mult.print();
-      cout << "   SIZE:" << mult.operators.size() << endl;
+    int newSize = 0;
+    for(int i = 0; i < productCount; i++){
+      if(absorbed[i]) continue;
+      if(newSize != i) copy_n((*this)[i], productWords, (*this)[newSize]);
+      newSize++;
     }
+    words.resize(newSize*productWords);
+  }
 
-    cout << this->funcName << ": ";
-    // Select the term with the implicant with the least minterms if it is a sum.
-    int leastOperationCount;
-    // Count of the individual gates.
-    int andCount, orCount, notCount;
-    if(mult.type == IMPLICANT_SUM){
-      leastOperationCount = mult.operators[0].getOperationCount(numInputs, &andCount, &orCount, &notCount);
-      int leastOperationIndex = 0;
-      for(int i = 1; i < mult.operators.size(); i++){
-        int thisOpCount = mult.operators[i].getOperationCount(numInputs, &andCount, &orCount, &notCount);
-        if(thisOpCount < leastOperationCount){
-          leastOperationCount = thisOpCount;
-          leastOperationIndex = i;
+  // @return true if all the implicants of product a are also in product b.
+  bool isSubset(uint64_t* a, uint64_t* b){
+    for(int w = 0; w < productWords; w++){
+      if(a[w] & ~b[w]) return false;
+    }
+    return true;
+  }
+
+  int countImplicants(int index){
+    int count = 0;
+    uint64_t* product = (*this)[index];
+    for(int w = 0; w < productWords; w++){
+      count += popCount(product[w]);
+    }
+    return count;
+  }
+
+  // @return The indexes of the implicants of a product.
+  vector<int> getImplicants(int index){
+    vector<int> ret;
+    uint64_t* product = (*this)[index];
+    for(int w = 0; w < productWords; w++){
+      for(int bit = 0; bit < 64; bit++){
+        if(product[w] & (1ULL<<bit)) ret.push_back((w<<6) + bit);
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Number of logic operations of a product, as in ImplicantOperation::getOperationCount.
+   * 
+   * @param index Index of the product.
+   * @param implicantCosts Number of operations of each implicant.
+   * @return int The number of operations.
+   */
+  int getOperationCount(int index, vector<int> &implicantCosts){
+    vector<int> implicants = getImplicants(index);
+    int opCount = implicants.size() - 1; // Number of OR operations.
+    for(int imp : implicants){
+      opCount += implicantCosts[imp];
+    }
+    return opCount;
+  }
+
+  // @return The index of the first product with the least number of operations.
+  int getCheapest(vector<int> &implicantCosts){
+    int cheapestIndex = 0;
+    int cheapestCount = getOperationCount(0, implicantCosts);
+    for(int i = 1; i < size(); i++){
+      int count = getOperationCount(i, implicantCosts);
+      if(count < cheapestCount){
+        cheapestCount = count;
+        cheapestIndex = i;
+      }
+    }
+    return cheapestIndex;
+  }
+
+  /**
+   * @brief Removes the most expensive products, keeping at least the cheapest one. As products only get
+   * more implicants when multiplied, the cost of a product is a lower bound of the final cost of all 
+   * the products that come from it.
+   * 
+   * @param implicantCosts Number of operations of each implicant.
+   * @param baseCost Number of operations added to each product by the rest of the function.
+   * @param maxProducts Number of products that are kept, or 0 to keep all of them.
+   * @param costLimit Products whose cost (plus baseCost) is greater are removed. None if -1.
+   * @return int The lowest cost of the removed products (plus baseCost), or INT_MAX if none was removed.
+   */
+  int prune(vector<int> &implicantCosts, int baseCost, int maxProducts, int costLimit){
+    int productCount = size();
+    vector<int> costs(productCount);
+    vector<int> order(productCount);
+    for(int i = 0; i < productCount; i++){
+      costs[i] = baseCost + getOperationCount(i, implicantCosts);
+      order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b){ return costs[a] < costs[b]; });
+
+    int keptCount = maxProducts > 0 ? min(maxProducts, productCount) : productCount;
+    if(costLimit >= 0){
+      while(keptCount > 1 && costs[order[keptCount-1]] > costLimit) keptCount--;
+    }
+    if(keptCount == productCount) return INT_MAX;
+
+    // Remove the rest without changing the order of the products that are kept.
+    vector<bool> removed(productCount, false);
+    for(int i = keptCount; i < productCount; i++){
+      removed[order[i]] = true;
+    }
+    int newSize = 0;
+    for(int i = 0; i < productCount; i++){
+      if(removed[i]) continue;
+      if(newSize != i) copy_n((*this)[i], productWords, (*this)[newSize]);
+      newSize++;
+    }
+    words.resize(newSize*productWords);
+    return costs[order[keptCount]];
+  }
+
+  // Prints the products, where bit i of a product stands for imps[indexes[i]].
+  template<typename Bits>
+  void print(ostream &stream, Implicants<Bits> &imps, vector<int> &indexes){
+    stream << "[";
+    for(int i = 0; i < size(); i++){
+      vector<int> implicants = getImplicants(i);
+      for(size_t j = 0; j < implicants.size(); j++){
+        imps[indexes[implicants[j]]].print(stream);
+        if(j != implicants.size()-1) stream << "*";
+      }
+      if(i != size()-1) stream << "+";
+    }
+    stream << "]";
+  }
+}SumOfProducts;
+
+/**
+ * @brief Prime implicant chart: the minterms of the function (columns) that are covered by each prime
+ * implicant (rows). Before running Petrick's method, the chart is reduced by selecting the essential
+ * prime implicants and removing the dominated rows and columns, so that only its cyclic core remains.
+ * 
+ * The chart may also be of several functions (outputs) at once. Then, there is a column for each 
+ * minterm of each output and a row for each implicant and output the implicant can be used on. The
+ * rows of the same implicant share its operations, so they are only counted once.
+ */
+typedef struct PrimeChart{
+  // Index of the implicant of each row.
+  vector<int> rowImplicants;
+  // Output of each row.
+  vector<int> rowOutputs;
+  // Number of operations of the implicant of each row.
+  vector<int> rowCosts;
+  // Rows of each implicant.
+  vector<vector<int>> implicantRows;
+  // Sorted indexes of the columns covered by each row.
+  vector<vector<int>> rowColumns;
+  // Sorted indexes of the rows that cover each column.
+  vector<vector<int>> columnRows;
+  vector<bool> activeRows;
+  vector<bool> activeColumns;
+  // If an implicant can be on more than one row (on more than one output).
+  bool sharedImplicants = false;
+  // Rows selected for the cover while reducing the chart.
+  vector<int> selectedRows;
+  // If not null, the passes of reduce stop once it is exceeded. The rows and columns that were not 
+  // checked yet stay on the chart.
+  Budget *budget = 0;
+
+  /**
+   * @brief Construct a new Prime Chart.
+   * 
+   * @param imps The prime implicants. Each one gets a row for each of its outputs.
+   * @param outputMinterms The minterms (not the Do-Not-Care ones) of each output.
+   * @param numInputs The number of inputs of the function.
+   */
+  template<typename Bits>
+  PrimeChart(Implicants<Bits> &imps, vector<Minterms<Bits>> &outputMinterms, int numInputs){
+    vector<vector<int>> outputRows(outputMinterms.size());
+    implicantRows.resize(imps.size());
+    for(size_t i = 0; i < imps.size(); i++){
+      int andCount = 0, notCount = 0;
+      int cost = imps[i].getOperationCount(numInputs, &andCount, &notCount);
+      for(size_t output = 0; output < outputMinterms.size(); output++){
+        if(!((imps[i].outputs>>output)&0x01)) continue;
+        outputRows[output].push_back(rowImplicants.size());
+        implicantRows[i].push_back(rowImplicants.size());
+        rowImplicants.push_back(i);
+        rowOutputs.push_back(output);
+        rowCosts.push_back(cost);
+      }
+      if(implicantRows[i].size() > 1) sharedImplicants = true;
+    }
+    rowColumns.resize(rowImplicants.size());
+    activeRows.resize(rowImplicants.size(), true);
+
+    // The column of the minterm m of an output is firstColumn plus the position of m on the sorted 
+    // minterms of the output. The minterms of each row are visited in order, so each one is searched 
+    // after the last one that was found, and the columns of the rows and the rows of the columns are 
+    // already sorted. The implicants with more minterms than the output (mostly Do-Not-Care ones) 
+    // check the minterms of the output instead.
+    for(size_t output = 0; output < outputMinterms.size(); output++){
+      Minterms<Bits> &minterms = outputMinterms[output];
+      int firstColumn = columnRows.size();
+      columnRows.resize(firstColumn + minterms.size());
+      for(int row : outputRows[output]){
+        auto addColumn = [&](int m){
+          columnRows[firstColumn + m].push_back(row);
+          rowColumns[row].push_back(firstColumn + m);
+        };
+        Implicant<Bits> &imp = imps[rowImplicants[row]];
+        if(imp.dashCount >= 63 || (1ULL << imp.dashCount) > minterms.size()){
+          for(size_t m = 0; m < minterms.size(); m++){
+            if(imp.covers(minterms[m])) addColumn(m);
+          }
+          continue;
+        }
+        auto next = minterms.begin();
+        imp.forEachMinterm([&](Bits min){
+          uint64_t value = lowBits(min);
+          next = lower_bound(next, minterms.end(), value, [](Minterm<Bits> &m, uint64_t v){ return lowBits(m.val) < v; });
+          if(next != minterms.end() && lowBits(next->val) == value) addColumn(next - minterms.begin());
+        });
+      }
+    }
+    activeColumns.resize(columnRows.size(), true);
+    // Remove the rows that only cover Do-Not-Care minterms.
+    removeInactive();
+  }
+
+  // Reduces the chart till no more rows or columns can be removed, or till the budget is exceeded.
+  void reduce(Budget *limits = 0){
+    budget = limits;
+    bool anyChange = true;
+    while(anyChange && !(budget && budget->check())){
+      anyChange = selectEssentialRows();
+      anyChange |= removeDominatedColumns();
+      // When implicants are shared, replacing a row by a cheaper one does not always make the cover 
+      // cheaper: the operations of the replaced implicant may still be needed for other outputs.
+      if(!sharedImplicants) anyChange |= removeDominatedRows();
+    }
+  }
+
+  // @return The indexes of the rows that are still on the chart.
+  vector<int> getActiveRows(){
+    vector<int> ret;
+    for(size_t row = 0; row < activeRows.size(); row++){
+      if(activeRows[row]) ret.push_back(row);
+    }
+    return ret;
+  }
+
+  // @return The indexes of the columns that are still on the chart.
+  vector<int> getActiveColumns(){
+    vector<int> ret;
+    for(size_t column = 0; column < activeColumns.size(); column++){
+      if(activeColumns[column]) ret.push_back(column);
+    }
+    return ret;
+  }
+
+  private:
+  /**
+   * @brief A column that is only covered by one row makes that row essential: it is selected and 
+   * removed from the chart together with all the columns it covers.
+   * 
+   * @return true If any row was selected.
+   */
+  bool selectEssentialRows(){
+    bool anyChange = false;
+    for(size_t column = 0; column < columnRows.size(); column++){
+      if(!activeColumns[column] || columnRows[column].size() != 1) continue;
+
+      int row = columnRows[column][0];
+      selectedRows.push_back(row);
+      activeRows[row] = false;
+      for(int coveredColumn : rowColumns[row]){
+        activeColumns[coveredColumn] = false;
+      }
+      anyChange = true;
+    }
+    if(anyChange) removeInactive();
+    return anyChange;
+  }
+
+  /**
+   * @brief If all the rows that cover column A also cover column B, any cover of A covers B, so B is
+   * removed.
+   * 
+   * @return true If any column was removed.
+   */
+  bool removeDominatedColumns(){
+    bool anyChange = false;
+    for(int columnA = 0; columnA < (int) columnRows.size(); columnA++){
+      if(columnA % 256 == 0 && budget && budget->check()) break;
+      if(!activeColumns[columnA]) continue;
+
+      // B must be covered by every row of A, so it is enough to look at the columns of the smallest row.
+      int smallestRow = columnRows[columnA][0];
+      for(int row : columnRows[columnA]){
+        if(rowColumns[row].size() < rowColumns[smallestRow].size()) smallestRow = row;
+      }
+
+      for(int columnB : rowColumns[smallestRow]){
+        if(columnB == columnA || !activeColumns[columnB]) continue;
+        if(includes(columnRows[columnB].begin(), columnRows[columnB].end(),
+                    columnRows[columnA].begin(), columnRows[columnA].end())){
+          activeColumns[columnB] = false;
+          anyChange = true;
+        }
+      }
+    }
+    if(anyChange) removeInactive();
+    return anyChange;
+  }
+
+  /**
+   * @brief If row A covers all the columns of row B and has the same or less number of operations, 
+   * B can be replaced by A on any cover without increasing its cost, so B is removed.
+   * 
+   * @return true If any row was removed.
+   */
+  bool removeDominatedRows(){
+    bool anyChange = false;
+    for(int rowB = 0; rowB < (int) rowColumns.size(); rowB++){
+      if(rowB % 256 == 0 && budget && budget->check()) break;
+      if(!activeRows[rowB]) continue;
+
+      // A must cover every column of B, so it is enough to look at the rows of the smallest column.
+      int smallestColumn = rowColumns[rowB][0];
+      for(int column : rowColumns[rowB]){
+        if(columnRows[column].size() < columnRows[smallestColumn].size()) smallestColumn = column;
+      }
+
+      for(int rowA : columnRows[smallestColumn]){
+        if(rowA == rowB || !activeRows[rowA] || rowCosts[rowA] > rowCosts[rowB]) continue;
+        if(!includes(rowColumns[rowA].begin(), rowColumns[rowA].end(),
+                     rowColumns[rowB].begin(), rowColumns[rowB].end())) continue;
+
+        // If both rows are equal, keep the first one.
+        if(rowCosts[rowA] == rowCosts[rowB] && rowColumns[rowA].size() == rowColumns[rowB].size() &&
+           rowA > rowB) continue;
+
+        activeRows[rowB] = false;
+        anyChange = true;
+        break;
+      }
+    }
+    if(anyChange) removeInactive();
+    return anyChange;
+  }
+
+  // Removes the inactive rows and columns from the lists, and the rows that do not cover any column.
+  void removeInactive(){
+    for(size_t row = 0; row < rowColumns.size(); row++){
+      vector<int> &columns = rowColumns[row];
+      columns.erase(remove_if(columns.begin(), columns.end(), [&](int c){ return !activeColumns[c]; }),
+                    columns.end());
+      if(columns.empty()) activeRows[row] = false;
+    }
+    for(size_t column = 0; column < columnRows.size(); column++){
+      vector<int> &rows = columnRows[column];
+      rows.erase(remove_if(rows.begin(), rows.end(), [&](int r){ return !activeRows[r]; }), 
+                 rows.end());
+    }
+  }
+}PrimeChart;
+
+/**
+ * @brief Searches the cover of least number of operations of a PrimeChart by branch and bound. It 
+ * follows the same cost as ImplicantOperation::getOperationCount: the operations of each implicant of
+ * the cover plus one OR for each implicant but the first. Branches that cannot get a cover cheaper 
+ * than the best one found so far are cut, so that memory only grows with the depth of the search.
+ * 
+ * On charts of several outputs, the operations of an implicant are only counted on the first row of
+ * the implicant that is selected, and each output needs its own OR gates.
+ */
+typedef struct BranchAndBound{
+  PrimeChart &chart;
+  // Number of selected rows of each implicant.
+  vector<int> implicantSelections;
+  // Number of selected rows that cover each column. Zero if the column is uncovered.
+  vector<int> columnCoverCount;
+  int uncoveredColumns = 0;
+  // Rows that cannot be selected on the current branch, as the branches with them were already searched.
+  vector<bool> bannedRows;
+  vector<int> selectedRows;
+  int selectedWeight = 0;
+  vector<int> bestRows;
+  int bestWeight;
+  // Nodes of the search tree that have been visited.
+  uint64_t searchNodes = 0;
+  // Rows of a previous cover, which may not cover all the columns. If they are given, the search starts
+  // from the cheapest cover of those rows and the greedy cover.
+  vector<int> startRows;
+  // If not null, the search stops once it is exceeded and returns the best cover found until then.
+  Budget *budget = 0;
+
+  BranchAndBound(PrimeChart &c) : chart(c){
+    implicantSelections.resize(chart.implicantRows.size(), 0);
+    for(int row : chart.selectedRows){
+      implicantSelections[chart.rowImplicants[row]]++;
+    }
+    columnCoverCount.resize(chart.columnRows.size(), 1);
+    for(int column : chart.getActiveColumns()){
+      columnCoverCount[column] = 0;
+      uncoveredColumns++;
+    }
+    bannedRows.resize(chart.rowColumns.size(), false);
+  }
+
+  // @return The rows of the chart, besides the ones selected on the chart, that form the cover of least cost.
+  vector<int> solve(){
+    // Start from a greedy cover so that most of the branches are cut from the beginning.
+    bestRows = greedyCover();
+    bestWeight = 0;
+    for(int row : bestRows){
+      bestWeight += getRowWeight(row);
+      selectRow(row);
+    }
+    for(int i = bestRows.size()-1; i >= 0; i--){
+      unselectRow(bestRows[i]);
+    }
+
+    if(!startRows.empty()){
+      // Complete the previous cover with the greedy one.
+      vector<int> rows;
+      int weight = 0;
+      for(int row : startRows){
+        if(!chart.activeRows[row]) continue;
+        bool coversColumn = false;
+        for(int column : chart.rowColumns[row]){
+          if(columnCoverCount[column] == 0) coversColumn = true;
+        }
+        if(!coversColumn) continue;
+        weight += getRowWeight(row);
+        selectRow(row);
+        rows.push_back(row);
+      }
+      for(int row : greedyCover()){
+        weight += getRowWeight(row);
+        selectRow(row);
+        rows.push_back(row);
+      }
+      for(int i = rows.size()-1; i >= 0; i--){
+        unselectRow(rows[i]);
+      }
+      if(weight < bestWeight){
+        bestWeight = weight;
+        bestRows = rows;
+      }
+    }
+
+    search();
+    return bestRows;
+  }
+
+  /**
+   * @brief Weighted set cover without searching: the greedy cover, whose rows are chosen by the 
+   * columns they cover for the operations they cost.
+   * 
+   * @param optimal Set if the cover is proven the cheapest one, as its cost is the lower bound.
+   * @return vector<int> The rows of the cover, besides the ones selected on the chart.
+   */
+  vector<int> solveGreedy(bool &optimal){
+    vector<int> rows = greedyCover();
+    bestWeight = INT_MAX;
+    int bound = lowerBound();
+    int weight = 0;
+    for(int row : rows){
+      weight += getRowWeight(row);
+      selectRow(row);
+    }
+    for(int i = rows.size()-1; i >= 0; i--){
+      unselectRow(rows[i]);
+    }
+    optimal = weight <= bound;
+    return rows;
+  }
+
+  private:
+  // Cost of selecting a row: the operations of its implicant, if it has not been selected on other 
+  // row, plus the OR that joins it to the rest of the cover of its output.
+  int getRowWeight(int row){
+    if(implicantSelections[chart.rowImplicants[row]] != 0) return 1;
+    return chart.rowCosts[row] + 1;
+  }
+
+  void search(){
+    // The clock is only read every few nodes.
+    if(budget && (budget->exceeded || (searchNodes % 1024 == 0 && budget->check()))) return;
+    searchNodes++;
+    if(uncoveredColumns == 0){
+      if(selectedWeight < bestWeight){
+        bestWeight = selectedWeight;
+        bestRows = selectedRows;
+      }
+      return;
+    }
+    if(selectedWeight + lowerBound() >= bestWeight) return;
+
+    // Branch on the uncovered column with the least rows that can cover it.
+    int branchColumn = -1, branchRowCount = 0;
+    for(size_t column = 0; column < columnCoverCount.size(); column++){
+      if(columnCoverCount[column] != 0) continue;
+      int rowCount = 0;
+      for(int row : chart.columnRows[column]){
+        if(!bannedRows[row]) rowCount++;
+      }
+      if(rowCount == 0) return; // This column cannot be covered on this branch.
+      if(branchColumn == -1 || rowCount < branchRowCount){
+        branchColumn = column;
+        branchRowCount = rowCount;
+      }
+    }
+
+    // Try first the rows that cover more columns for their cost.
+    vector<int> rows;
+    for(int row : chart.columnRows[branchColumn]){
+      if(!bannedRows[row]) rows.push_back(row);
+    }
+    vector<int> newCoverage(chart.rowColumns.size()), weights(chart.rowColumns.size());
+    for(int row : rows){
+      weights[row] = getRowWeight(row);
+      for(int column : chart.rowColumns[row]){
+        if(columnCoverCount[column] == 0) newCoverage[row]++;
+      }
+    }
+    stable_sort(rows.begin(), rows.end(), [&](int a, int b){
+      return weights[a]*newCoverage[b] < weights[b]*newCoverage[a];
+    });
+
+    for(int row : rows){
+      selectedWeight += weights[row];
+      selectRow(row);
+      search();
+      unselectRow(row);
+      selectedWeight -= weights[row];
+      // All the covers with this row have been searched.
+      bannedRows[row] = true;
+    }
+    for(int row : rows){
+      bannedRows[row] = false;
+    }
+  }
+
+  /**
+   * @brief Columns that cannot be covered by the same implicant need different implicants to be 
+   * covered. Picks a group of those columns and adds the cost of the cheapest row of each one.
+   * 
+   * @return int The lower bound of the cost of covering the uncovered columns.
+   */
+  int lowerBound(){
+    int bound = 0;
+    vector<bool> sharesImplicant(columnCoverCount.size(), false);
+    for(size_t column = 0; column < columnCoverCount.size(); column++){
+      if(columnCoverCount[column] != 0 || sharesImplicant[column]) continue;
+
+      int cheapestWeight = -1;
+      for(int row : chart.columnRows[column]){
+        if(bannedRows[row]) continue;
+        int weight = getRowWeight(row);
+        if(cheapestWeight == -1 || weight < cheapestWeight) cheapestWeight = weight;
+        for(int implicantRow : chart.implicantRows[chart.rowImplicants[row]]){
+          for(int otherColumn : chart.rowColumns[implicantRow]){
+            sharesImplicant[otherColumn] = true;
+          }
+        }
+      }
+      if(cheapestWeight == -1) return bestWeight; // Cannot be covered.
+      bound += cheapestWeight;
+    }
+    return bound;
+  }
+
+  // Repeatedly selects the row that covers more uncovered columns for its cost. Each selection goes 
+  // through all the rows, so once the budget is exceeded the columns that are left get their cheapest 
+  // row on a single pass.
+  vector<int> greedyCover(){
+    vector<int> ret;
+    vector<int> rows = chart.getActiveRows();
+    while(uncoveredColumns != 0){
+      if(budget && budget->check()){
+        for(size_t column = 0; column < columnCoverCount.size(); column++){
+          if(columnCoverCount[column] != 0) continue;
+          int cheapestRow = chart.columnRows[column][0];
+          for(int row : chart.columnRows[column]){
+            if(getRowWeight(row) < getRowWeight(cheapestRow)) cheapestRow = row;
+          }
+          selectRow(cheapestRow);
+          ret.push_back(cheapestRow);
+        }
+        break;
+      }
+      int bestRow = -1, bestCoverage = 0, bestRowWeight = 0;
+      for(int row : rows){
+        int coverage = 0;
+        for(int column : chart.rowColumns[row]){
+          if(columnCoverCount[column] == 0) coverage++;
+        }
+        if(coverage == 0) continue;
+        int weight = getRowWeight(row);
+        if(bestRow == -1 || coverage*bestRowWeight > bestCoverage*weight){
+          bestRow = row;
+          bestCoverage = coverage;
+          bestRowWeight = weight;
+        }
+      }
+      selectRow(bestRow);
+      ret.push_back(bestRow);
+    }
+    for(int i = ret.size()-1; i >= 0; i--){
+      unselectRow(ret[i]);
+    }
+
+    // The first rows may be covered by the later ones. Those are dropped, starting from the most 
+    // expensive ones.
+    vector<int> coverCount = columnCoverCount;
+    for(int row : ret){
+      for(int column : chart.rowColumns[row]) coverCount[column]++;
+    }
+    vector<int> order = ret;
+    stable_sort(order.begin(), order.end(), [&](int a, int b){ return chart.rowCosts[a] > chart.rowCosts[b]; });
+    vector<bool> redundant(chart.rowColumns.size(), false);
+    for(int row : order){
+      bool needed = false;
+      for(int column : chart.rowColumns[row]){
+        if(coverCount[column] == 1) needed = true;
+      }
+      if(needed) continue;
+      redundant[row] = true;
+      for(int column : chart.rowColumns[row]) coverCount[column]--;
+    }
+    ret.erase(remove_if(ret.begin(), ret.end(), [&](int row){ return redundant[row]; }), ret.end());
+    return ret;
+  }
+
+  void selectRow(int row){
+    selectedRows.push_back(row);
+    implicantSelections[chart.rowImplicants[row]]++;
+    for(int column : chart.rowColumns[row]){
+      if(columnCoverCount[column]++ == 0) uncoveredColumns--;
+    }
+  }
+
+  void unselectRow(int row){
+    selectedRows.pop_back();
+    implicantSelections[chart.rowImplicants[row]]--;
+    for(int column : chart.rowColumns[row]){
+      if(--columnCoverCount[column] == 0) uncoveredColumns++;
+    }
+  }
+}BranchAndBound;
+
+#ifdef PETRICK_Z3
+/**
+ * @brief Searches the cover of least number of operations of a PrimeChart as a 0-1 integer program,
+ * solved by the optimizer of Z3. Each row and each implicant is a variable: every column needs one of 
+ * its rows, every row needs its implicant, and the cost is one OR for each row plus the operations of
+ * each implicant, counted once, as on BranchAndBound. 
+ */
+typedef struct IlpCover{
+  PrimeChart &chart;
+  // If not null, the solver stops at the time limit of the budget.
+  Budget *budget = 0;
+
+  IlpCover(PrimeChart &c) : chart(c){}
+
+  /**
+   * @param rows Gets the rows of the cheapest cover, besides the ones selected on the chart.
+   * @return false if the solver stopped before proving the cover, so no rows are given.
+   */
+  bool solve(vector<int> &rows){
+    vector<int> activeRows = chart.getActiveRows();
+    if(activeRows.empty()) return true;
+    vector<bool> selectedImplicants(chart.implicantRows.size(), false);
+    for(int row : chart.selectedRows){
+      selectedImplicants[chart.rowImplicants[row]] = true;
+    }
+
+    z3::context context;
+    z3::optimize optimizer(context);
+    z3::expr_vector rowVariables(context), implicantVariables(context);
+    vector<int> rowIndexes(chart.rowColumns.size()), implicantIndexes(chart.implicantRows.size(), -1);
+    for(int row : activeRows){
+      rowIndexes[row] = rowVariables.size();
+      rowVariables.push_back(context.bool_const(("r" + to_string(row)).c_str()));
+      optimizer.add_soft(!rowVariables.back(), 1);
+
+      // The operations of the implicants that are already selected are not counted again.
+      int implicant = chart.rowImplicants[row];
+      if(selectedImplicants[implicant]) continue;
+      if(implicantIndexes[implicant] == -1){
+        implicantIndexes[implicant] = implicantVariables.size();
+        implicantVariables.push_back(context.bool_const(("i" + to_string(implicant)).c_str()));
+        if(chart.rowCosts[row] > 0) optimizer.add_soft(!implicantVariables.back(), chart.rowCosts[row]);
+      }
+      optimizer.add(z3::implies(rowVariables.back(), implicantVariables[implicantIndexes[implicant]]));
+    }
+    for(int column : chart.getActiveColumns()){
+      z3::expr_vector coveringRows(context);
+      for(int row : chart.columnRows[column]){
+        coveringRows.push_back(rowVariables[rowIndexes[row]]);
+      }
+      optimizer.add(z3::mk_or(coveringRows));
+    }
+
+    if(budget && budget->seconds > 0){
+      chrono::duration<double, milli> remaining = budget->deadline - chrono::steady_clock::now();
+      if(remaining.count() < 1){
+        budget->exceeded = true;
+        return false;
+      }
+      z3::params params(context);
+      params.set("timeout", (unsigned) min(remaining.count(), (double) UINT_MAX));
+      optimizer.set(params);
+    }
+    if(optimizer.check() != z3::sat){
+      if(budget) budget->check();
+      return false;
+    }
+
+    z3::model model = optimizer.get_model();
+    for(int row : activeRows){
+      if(model.eval(rowVariables[rowIndexes[row]], true).is_true()) rows.push_back(row);
+    }
+    return true;
+  }
+}IlpCover;
+#endif
+
+// Largest cyclic cores of the chart (after PrimeChart::reduce), by their number of rows, that the auto
+// solver gives to the exact solvers: bnb for the smallest ones and, if petrick was built with Z3, ilp 
+// for the rest up to its limit. The larger ones get the greedy cover.
+const int AUTO_BNB_ROWS = 50;
+const int AUTO_ILP_ROWS = 300;
+
+/**
+ * @brief Chooses how the cyclic core of a chart is covered with the auto solver.
+ * 
+ * @param chart The reduced prime implicant chart.
+ * @return SolverType SOLVER_BNB, SOLVER_ILP or SOLVER_GREEDY.
+ */
+SolverType chooseCoverSolver(PrimeChart &chart){
+  int rows = chart.getActiveRows().size();
+  if(rows <= AUTO_BNB_ROWS) return SOLVER_BNB;
+#ifdef PETRICK_Z3
+  if(rows <= AUTO_ILP_ROWS) return SOLVER_ILP;
+#endif
+  return SOLVER_GREEDY;
+}
+
+/**
+ * @brief Heuristic minimization of a function given as cubes, following the loop of Espresso: the 
+ * cubes are expanded into prime implicants, the redundant ones are removed, and the rest are reduced
+ * to the smallest cubes that still keep the cover, so that the next expansion can find a cheaper one.
+ * The loop stops when the number of operations of the cover does not improve. Neither the minterms 
+ * nor all the prime implicants of the function are listed, so it works on functions with many inputs,
+ * but the result may not be the cheapest cover.
+ * 
+ * The cubes follow the convention of Implicant: the bits outside the inputs are set on the mask and 
+ * zero on the value.
+ */
+template<typename Bits>
+struct Espresso{
+  int numInputs;
+  // Bits of the inputs of the function.
+  Bits inputsMask;
+  Implicants<Bits> onSet;
+  Implicants<Bits> dncSet;
+  // Cubes where the function is zero.
+  Implicants<Bits> offSet;
+  // If not null, the loop stops once it is exceeded and the last cover is returned.
+  Budget *budget = 0;
+
+  Espresso(Implicants<Bits> &on, Implicants<Bits> &dnc, int nInp) : numInputs(nInp), onSet(on), dncSet(dnc){
+    inputsMask = inputBits<Bits>(nInp);
+  }
+
+  // @return The cubes of the minimized cover.
+  Implicants<Bits> minimize(){
+    Implicants<Bits> function = onSet;
+    function.insert(function.end(), dncSet.begin(), dncSet.end());
+    offSet = complement(function);
+    // The cubes of the function are already a cover, although not a reduced one.
+    if(budget && budget->check(offSet.size()*sizeof(Implicant<Bits>))) return onSet;
+
+    Implicants<Bits> cover = irredundant(expand(onSet));
+    int cost = getOperationCount(cover);
+    while(!(budget && budget->check())){
+      Implicants<Bits> newCover = irredundant(expand(reduce(cover)));
+      int newCost = getOperationCount(newCover);
+      if(newCost >= cost) break;
+      cover = newCover;
+      cost = newCost;
+    }
+    return cover;
+  }
+
+  private:
+  // Each cube is expanded into a prime implicant by removing literals while it does not intersect 
+  // the OFF-set. The cubes that get covered by an expanded cube are removed.
+  Implicants<Bits> expand(Implicants<Bits> cover){
+    // Expand first the largest cubes, as they are the ones more likely to cover others.
+    stable_sort(cover.begin(), cover.end(), [](const Implicant<Bits> &a, const Implicant<Bits> &b){
+      return a.dashCount > b.dashCount;
+    });
+
+    Implicants<Bits> ret;
+    vector<bool> covered(cover.size(), false);
+    for(size_t i = 0; i < cover.size(); i++){
+      if(covered[i]) continue;
+      Implicant<Bits> cube = cover[i];
+      // Once the budget is exceeded, the rest of the cubes are kept as they are.
+      if(budget && budget->check()){
+        if(find(ret.begin(), ret.end(), cube) == ret.end()) ret.push_back(cube);
+        continue;
+      }
+
+      // Grow the cube to also cover other cubes of the cover, if it can be done without intersecting 
+      // the OFF-set. The cubes that need less literals removed are tried first.
+      vector<int> candidates;
+      for(size_t j = i+1; j < cover.size(); j++){
+        if(!covered[j]) candidates.push_back(j);
+      }
+      vector<int> raisedLiterals(cover.size());
+      for(int j : candidates){
+        raisedLiterals[j] = popCount(supercube(cube, cover[j]).commonBitsMask.val ^ cube.commonBitsMask.val);
+      }
+      stable_sort(candidates.begin(), candidates.end(), [&](int a, int b){ 
+        return raisedLiterals[a] < raisedLiterals[b]; 
+      });
+      for(int j : candidates){
+        Implicant<Bits> raised = supercube(cube, cover[j]);
+        if(!intersectsOffSet(raised)) cube = raised;
+      }
+
+      // Remove the rest of literals that can be removed. First the ones that are not blocked by an 
+      // adjacent cube of the OFF-set and, of those, the negated ones, as they need a NOT gate.
+      vector<int> blocking(numInputs, 0);
+      for(Implicant<Bits> &off : offSet){
+        Bits distance = (cube.value.val ^ off.value.val) & cube.commonBitsMask.val & off.commonBitsMask.val & inputsMask;
+        if(popCount(distance) == 1) blocking[bitIndex(distance)]++;
+      }
+      vector<int> literals;
+      for(int bit = 0; bit < numInputs; bit++){
+        if((cube.commonBitsMask.val>>bit)&0x01) literals.push_back(bit);
+      }
+      stable_sort(literals.begin(), literals.end(), [&](int a, int b){ 
+        if(blocking[a] != blocking[b]) return blocking[a] < blocking[b];
+        return ((cube.value.val>>a)&0x01) < ((cube.value.val>>b)&0x01);
+      });
+
+      for(int bit : literals){
+        Implicant<Bits> raised = makeCube(cube.value.val, cube.commonBitsMask.val & ~(Bits(1)<<bit));
+        if(!intersectsOffSet(raised)) cube = raised;
+      }
+
+      for(size_t j = i+1; j < cover.size(); j++){
+        if(!covered[j] && contains(cube, cover[j])) covered[j] = true;
+      }
+      bool isRepeated = false;
+      for(Implicant<Bits> &other : ret){
+        if(other == cube) isRepeated = true;
+      }
+      if(!isRepeated) ret.push_back(cube);
+    }
+    return ret;
+  }
+
+  // Removes, one by one, the cubes that are covered by the rest of cubes and the Do-Not-Care set. The 
+  // most expensive cubes are checked first.
+  Implicants<Bits> irredundant(Implicants<Bits> cover){
+    vector<int> costs;
+    for(Implicant<Bits> &cube : cover) costs.push_back(getOperationCount(cube));
+    vector<int> order(cover.size());
+    for(size_t i = 0; i < order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b){ return costs[a] > costs[b]; });
+
+    vector<bool> removed(cover.size(), false);
+    for(int i : order){
+      if(budget && budget->check()) break;
+      Implicants<Bits> rest = dncSet;
+      for(int j = 0; j < (int) cover.size(); j++){
+        if(j != i && !removed[j]) rest.push_back(cover[j]);
+      }
+      if(tautology(cofactor(rest, cover[i]))) removed[i] = true;
+    }
+
+    Implicants<Bits> ret;
+    for(size_t i = 0; i < cover.size(); i++){
+      if(!removed[i]) ret.push_back(cover[i]);
+    }
+    return ret;
+  }
+
+  // Each cube is reduced to the smallest cube that contains the minterms that are only covered by it.
+  Implicants<Bits> reduce(Implicants<Bits> cover){
+    stable_sort(cover.begin(), cover.end(), [](const Implicant<Bits> &a, const Implicant<Bits> &b){
+      return a.dashCount > b.dashCount;
+    });
+
+    vector<bool> removed(cover.size(), false);
+    for(size_t i = 0; i < cover.size(); i++){
+      Implicants<Bits> rest = dncSet;
+      for(size_t j = 0; j < cover.size(); j++){
+        if(j != i && !removed[j]) rest.push_back(cover[j]);
+      }
+      Implicants<Bits> uncovered = complement(cofactor(rest, cover[i]));
+      // The complement is not complete if the budget was exceeded while it was being calculated.
+      if(budget && budget->check()) break;
+      if(uncovered.empty()){
+        removed[i] = true;
+        continue;
+      }
+      Implicant<Bits> super = supercube(uncovered);
+      cover[i] = makeCube(cover[i].value.val | super.value.val, 
+                          cover[i].commonBitsMask.val | (super.commonBitsMask.val & inputsMask));
+    }
+
+    Implicants<Bits> ret;
+    for(size_t i = 0; i < cover.size(); i++){
+      if(!removed[i]) ret.push_back(cover[i]);
+    }
+    return ret;
+  }
+
+  // @return The cubes of the cover, seen from inside the cube c: the cubes that intersect c without the
+  // literals of c.
+  Implicants<Bits> cofactor(Implicants<Bits> &cover, Implicant<Bits> &c){
+    Implicants<Bits> ret;
+    Bits cubeMask = c.commonBitsMask.val & inputsMask;
+    for(Implicant<Bits> &cube : cover){
+      if(!intersects(cube, c)) continue;
+      ret.push_back(makeCube(cube.value.val, cube.commonBitsMask.val & ~cubeMask));
+    }
+    return ret;
+  }
+
+  // @return The cubes of the cover where the input bit has the value bitValue, without that input.
+  Implicants<Bits> cofactor(Implicants<Bits> &cover, int bit, bool bitValue){
+    Implicants<Bits> ret;
+    for(Implicant<Bits> &cube : cover){
+      if(((cube.commonBitsMask.val>>bit)&0x01) && ((cube.value.val>>bit)&0x01) != bitValue) continue;
+      ret.push_back(makeCube(cube.value.val, cube.commonBitsMask.val & ~(Bits(1)<<bit)));
+    }
+    return ret;
+  }
+
+  // @return true if the cover is 1 for every combination of inputs.
+  bool tautology(Implicants<Bits> cover){
+    // Once the budget is exceeded, the covers are taken as not tautologies, so no cube is removed.
+    if(cover.empty() || (budget && budget->check())) return false;
+    for(Implicant<Bits> &cube : cover){
+      if((cube.commonBitsMask.val & inputsMask) == 0) return true;
+    }
+
+    // If every input only appears as negated or only as non negated (the cover is unate), the 
+    // combination of inputs opposite to all the literals is not covered. 
+    int bit = getSplittingBit(cover, true);
+    if(bit < 0) return false;
+    return tautology(cofactor(cover, bit, false)) && tautology(cofactor(cover, bit, true));
+  }
+
+  // @return The cubes where the cover is 0. If the budget is exceeded, the result is not complete.
+  Implicants<Bits> complement(Implicants<Bits> cover){
+    Implicants<Bits> ret;
+    if(budget && budget->check()) return ret;
+    if(cover.empty()){
+      ret.push_back(makeCube(0, ~inputsMask));
+      return ret;
+    }
+    for(Implicant<Bits> &cube : cover){
+      if((cube.commonBitsMask.val & inputsMask) == 0) return ret;
+    }
+
+    if(cover.size() == 1){
+      // De Morgan, as disjoint cubes: ~(abc) = ~a + a~b + ab~c
+      Implicant<Bits> &cube = cover[0];
+      Bits mask = ~inputsMask;
+      for(int bit = numInputs-1; bit >= 0; bit--){
+        if(!((cube.commonBitsMask.val>>bit)&0x01)) continue;
+        Bits value = (cube.value.val & mask) | (~cube.value.val & (Bits(1)<<bit));
+        ret.push_back(makeCube(value, mask | (Bits(1)<<bit)));
+        mask |= Bits(1)<<bit;
+      }
+      return ret;
+    }
+
+    int bit = getSplittingBit(cover, false);
+    Implicants<Bits> zeros = complement(cofactor(cover, bit, false));
+    Implicants<Bits> ones = complement(cofactor(cover, bit, true));
+
+    // The cubes that are on both halves do not depend on the bit.
+    typename Implicant<Bits>::KeySet zeroKeys;
+    for(Implicant<Bits> &cube : zeros) zeroKeys.insert(cube.getKey());
+    typename Implicant<Bits>::KeySet mergedKeys;
+    for(Implicant<Bits> &cube : ones){
+      if(zeroKeys.count(cube.getKey())){
+        mergedKeys.insert(cube.getKey());
+        ret.push_back(cube);
+      }else{
+        ret.push_back(makeCube(cube.value.val | (Bits(1)<<bit), cube.commonBitsMask.val | (Bits(1)<<bit)));
+      }
+    }
+    for(Implicant<Bits> &cube : zeros){
+      if(mergedKeys.count(cube.getKey())) continue;
+      ret.push_back(makeCube(cube.value.val, cube.commonBitsMask.val | (Bits(1)<<bit)));
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Selects the input to split a cover when checking tautologies or complementing.
+   * 
+   * @param cover The cover.
+   * @param onlyBinate If true, only inputs that appear both negated and non negated are returned.
+   * @return int The input that appears most times, preferring those that are negated and non negated.
+   * -1 if onlyBinate and there is none.
+   */
+  int getSplittingBit(Implicants<Bits> &cover, bool onlyBinate){
+    int bestBit = -1, bestBinate = -1, bestCount = -1;
+    for(int bit = 0; bit < numInputs; bit++){
+      int ones = 0, zeros = 0;
+      for(Implicant<Bits> &cube : cover){
+        if(!((cube.commonBitsMask.val>>bit)&0x01)) continue;
+        if((cube.value.val>>bit)&0x01) ones++;
+        else zeros++;
+      }
+      int binate = min(ones, zeros);
+      if(binate > bestBinate || (binate == bestBinate && ones+zeros > bestCount)){
+        bestBit = bit;
+        bestBinate = binate;
+        bestCount = ones+zeros;
+      }
+    }
+    if(onlyBinate && bestBinate <= 0) return -1;
+    return bestBit;
+  }
+
+  bool intersectsOffSet(Implicant<Bits> &cube){
+    for(Implicant<Bits> &off : offSet){
+      if(intersects(cube, off)) return true;
+    }
+    return false;
+  }
+
+  // @return The smallest cube that contains both cubes.
+  Implicant<Bits> supercube(Implicant<Bits> &a, Implicant<Bits> &b){
+    Bits mask = a.commonBitsMask.val & b.commonBitsMask.val & ~(a.value.val ^ b.value.val);
+    return makeCube(a.value.val, mask);
+  }
+
+  // @return The smallest cube that contains all the cubes.
+  Implicant<Bits> supercube(Implicants<Bits> &cubes){
+    Bits mask = ~Bits(0), differentBits = 0;
+    for(Implicant<Bits> &cube : cubes){
+      mask &= cube.commonBitsMask.val;
+      differentBits |= cube.value.val ^ cubes[0].value.val;
+    }
+    return makeCube(cubes[0].value.val, mask & ~differentBits);
+  }
+
+  Implicant<Bits> makeCube(Bits value, Bits mask){
+    return Implicant<Bits>(value, mask, numInputs);
+  }
+
+  bool intersects(Implicant<Bits> &a, Implicant<Bits> &b){
+    return ((a.value.val ^ b.value.val) & a.commonBitsMask.val & b.commonBitsMask.val) == 0;
+  }
+
+  // @return true if all the minterms of b are in a.
+  bool contains(Implicant<Bits> &a, Implicant<Bits> &b){
+    return (a.commonBitsMask.val & ~b.commonBitsMask.val) == 0 && 
+           ((a.value.val ^ b.value.val) & a.commonBitsMask.val) == 0;
+  }
+
+  static int bitIndex(Bits singleBit){
+    int index = 0;
+    while(!((singleBit>>index)&0x01)) index++;
+    return index;
+  }
+
+  int getOperationCount(Implicant<Bits> &cube){
+    int andCount = 0, notCount = 0;
+    return cube.getOperationCount(numInputs, &andCount, &notCount);
+  }
+
+  // Number of operations of the cover, as in ImplicantOperation::getOperationCount.
+  int getOperationCount(Implicants<Bits> &cover){
+    int opCount = cover.size() - 1;
+    for(Implicant<Bits> &cube : cover){
+      opCount += getOperationCount(cube);
+    }
+    return opCount;
+  }
+};
+
+/**
+ * @brief Reduced ordered binary decision diagrams (BDDs) of functions, and zero-suppressed ones (ZDDs)
+ * of sets of cubes, to find the prime implicants of a function from its cubes without listing its 
+ * minterms or its Do-Not-Care bits (see Function::calculatePrimesBDD), so the cost grows with the 
+ * number of nodes, which stays small on the large Do-Not-Care sets of the truth tables (e.g. the rows 
+ * "1 1 x x x x x"), instead of with the number of minterms.
+ * 
+ * The variable v of the BDDs is the input v (0 for a). On the ZDDs, each input has two variables, 2*v
+ * for its literal and 2*v+1 for its negated literal, so each path to the terminal 1 is a cube. On both 
+ * of them, node 0 is the terminal 0 (or the empty set of cubes) and node 1 is the terminal 1 (or the 
+ * set with only the cube without literals).
+ */
+typedef struct DecisionDiagram{
+  typedef struct Node{
+    int var;
+    int low;
+    int high;
+  }Node;
+
+  // Most nodes of each kind of diagram, so that the variable and the children of a node fit on the 64
+  // bits of its key.
+  static constexpr int MAX_NODES = 1 << 27;
+
+  vector<Node> bddNodes;
+  vector<Node> zddNodes;
+  // Index of each node by its variable and its children, so that no node is built twice.
+  unordered_map<uint64_t, int> bddTable;
+  unordered_map<uint64_t, int> zddTable;
+  // Results of the operations that were already calculated, by their operands.
+  unordered_map<uint64_t, int> andCache, orCache, primeCache, differenceCache;
+  // Limits of the time and the memory. Once one is hit, every new node is the terminal 0, so the 
+  // results are not valid and the diagrams must be discarded.
+  Budget *budget = 0;
+
+  DecisionDiagram(){
+    // The terminals have a variable after all the others.
+    bddNodes = {Node{INT_MAX, 0, 0}, Node{INT_MAX, 1, 1}};
+    zddNodes = bddNodes;
+  }
+
+  // @return The BDD of the function "var ? high : low".
+  int bdd(int var, int low, int high){
+    if(low == high) return low;
+    return makeNode(bddNodes, bddTable, var, low, high);
+  }
+
+  // @return The ZDD of the cubes of low and the cubes of high with the literal var.
+  int zdd(int var, int low, int high){
+    if(high == 0) return low;
+    return makeNode(zddNodes, zddTable, var, low, high);
+  }
+
+  int bddAnd(int f, int g){
+    return apply(f, g, false);
+  }
+
+  int bddOr(int f, int g){
+    return apply(f, g, true);
+  }
+
+  // @return The BDD of the sum of the cubes.
+  template<typename Bits>
+  int bddOf(Implicants<Bits> &cubes, int numInputs){
+    return bddOf(cubes, 0, cubes.size(), numInputs);
+  }
+
+  /**
+   * @brief Calculates the prime implicants of a function (the largest cubes inside it) by the 
+   * recursion of Coudert and Madre: the ones without the first input x of f are the prime implicants 
+   * of f(x=0)*f(x=1), and the others are the ones of f(x=0), with x', and of f(x=1), with x, that are 
+   * not among those.
+   * 
+   * @param f The BDD of the function.
+   * @return int The ZDD of its prime implicants.
+   */
+  int primes(int f){
+    if(f <= 1) return f;
+    auto found = primeCache.find(f);
+    if(found != primeCache.end()) return found->second;
+
+    Node node = bddNodes[f];
+    int common = primes(bddAnd(node.low, node.high));
+    int negated = difference(primes(node.low), common);
+    int positive = difference(primes(node.high), common);
+    int result = zdd(2*node.var, zdd(2*node.var+1, common, negated), positive);
+    primeCache[f] = result;
+    return result;
+  }
+
+  // @return The ZDD of the cubes of p that are not on q.
+  int difference(int p, int q){
+    if(p == 0 || p == q) return 0;
+    if(q == 0) return p;
+    uint64_t key = (uint64_t) p << 32 | q;
+    auto found = differenceCache.find(key);
+    if(found != differenceCache.end()) return found->second;
+
+    Node a = zddNodes[p], b = zddNodes[q];
+    int result;
+    if(a.var < b.var) result = zdd(a.var, difference(a.low, q), a.high);
+    else if(a.var > b.var) result = difference(p, b.low);
+    else result = zdd(a.var, difference(a.low, b.low), difference(a.high, b.high));
+    differenceCache[key] = result;
+    return result;
+  }
+
+  /**
+   * @brief Adds the cubes of a ZDD to a list as implicants, which follow the convention of Implicant:
+   * the bits outside the inputs are set on the mask.
+   * 
+   * @param p The ZDD of the cubes.
+   * @param numInputs The number of inputs of the function.
+   * @param cubes Where the cubes are added.
+   */
+  template<typename Bits>
+  void getCubes(int p, int numInputs, Implicants<Bits> &cubes){
+    getCubes(p, numInputs, Bits(0), ~inputBits<Bits>(numInputs), cubes);
+  }
+
+  // Bytes used by the nodes, their tables and the caches of the operations, roughly.
+  uint64_t getUsedBytes(){
+    uint64_t entries = bddTable.size() + zddTable.size() + andCache.size() + orCache.size() + 
+                       primeCache.size() + differenceCache.size();
+    return (bddNodes.capacity() + zddNodes.capacity())*sizeof(Node) + entries*32;
+  }
+
+  private:
+  int makeNode(vector<Node> &nodes, unordered_map<uint64_t, int> &table, int var, int low, int high){
+    if(budget && (budget->exceeded || (nodes.size() % 4096 == 0 && budget->check(getUsedBytes())))){
+      return 0;
+    }
+    uint64_t key = (uint64_t) var << 54 | (uint64_t) low << 27 | (uint64_t) high;
+    auto found = table.find(key);
+    if(found != table.end()) return found->second;
+    if(nodes.size() >= MAX_NODES){
+      throw runtime_error("The decision diagrams of the function have more than " + to_string(MAX_NODES) + " nodes");
+    }
+    nodes.push_back(Node{var, low, high});
+    table.emplace(key, nodes.size()-1);
+    return nodes.size()-1;
+  }
+
+  // @return The BDD of f*g or, if sum is set, of f+g.
+  int apply(int f, int g, bool sum){
+    if(f == g) return f;
+    if(f > g) swap(f, g);
+    // The terminals are the nodes 0 and 1, so only f may be one of them.
+    if(f == 0) return sum ? g : 0;
+    if(f == 1) return sum ? 1 : g;
+    unordered_map<uint64_t, int> &cache = sum ? orCache : andCache;
+    uint64_t key = (uint64_t) f << 32 | g;
+    auto found = cache.find(key);
+    if(found != cache.end()) return found->second;
+
+    Node a = bddNodes[f], b = bddNodes[g];
+    int var = min(a.var, b.var);
+    int low = apply(a.var == var ? a.low : f, b.var == var ? b.low : g, sum);
+    int high = apply(a.var == var ? a.high : f, b.var == var ? b.high : g, sum);
+    int result = bdd(var, low, high);
+    cache[key] = result;
+    return result;
+  }
+
+  // @return The BDD of the sum of cubes[first, last), added by halves so that the operands of each 
+  // sum are of similar size.
+  template<typename Bits>
+  int bddOf(Implicants<Bits> &cubes, size_t first, size_t last, int numInputs){
+    if(last - first > 1){
+      size_t middle = first + (last - first)/2;
+      return bddOr(bddOf(cubes, first, middle, numInputs), bddOf(cubes, middle, last, numInputs));
+    }
+    if(last == first) return 0;
+    // The cube is built from its last input, which is the lowest node.
+    int node = 1;
+    for(int input = numInputs-1; input >= 0; input--){
+      int bit = numInputs-1-input;
+      if(!((cubes[first].commonBitsMask.val >> bit) & Bits(1))) continue;
+      if((cubes[first].value.val >> bit) & Bits(1)) node = bdd(input, 0, node);
+      else node = bdd(input, node, 0);
+    }
+    return node;
+  }
+
+  template<typename Bits>
+  void getCubes(int p, int numInputs, Bits value, Bits mask, Implicants<Bits> &cubes){
+    if(p == 0 || (budget && budget->exceeded)) return;
+    if(p == 1){
+      cubes.push_back(Implicant<Bits>(value, mask, numInputs));
+      if(cubes.size() % 4096 == 0 && budget) budget->check(getUsedBytes() + cubes.size()*sizeof(Implicant<Bits>));
+      return;
+    }
+    Node node = zddNodes[p];
+    getCubes(node.low, numInputs, value, mask, cubes);
+    Bits bit = Bits(1) << (numInputs-1-node.var/2);
+    getCubes(node.high, numInputs, node.var % 2 == 0 ? value | bit : value, mask | bit, cubes);
+  }
+}DecisionDiagram;
+
+/**
+ * @brief Pool of threads to run the iterations of loops in parallel. The thread that calls parallelFor
+ * also runs iterations of the loop, so loops can be nested: if all the threads of the pool are busy,
+ * the inner loop is run by the thread that called it.
+ */
+typedef struct ThreadPool{
+  private:
+  typedef struct Loop{
+    function<void(int)> body;
+    int count;
+    // Next iteration to run and number of iterations that have finished.
+    atomic<int> next{0};
+    atomic<int> finished{0};
+    // First exception thrown by an iteration, thrown again by parallelFor.
+    exception_ptr error;
+    mutex lock;
+    condition_variable done;
+  }Loop;
+
+  vector<thread> workers;
+  // Loops that may have iterations that have not started.
+  deque<shared_ptr<Loop>> loops;
+  mutex lock;
+  condition_variable newLoop;
+  bool stopping = false;
+
+  public:
+  // Uses threadCount threads, counting the thread that calls parallelFor.
+  ThreadPool(int threadCount){
+    for(int i = 1; i < threadCount; i++){
+      workers.push_back(thread([this](){ work(); }));
+    }
+  }
+
+  ~ThreadPool(){
+    {
+      lock_guard<mutex> guard(lock);
+      stopping = true;
+    }
+    newLoop.notify_all();
+    for(thread &worker : workers){
+      worker.join();
+    }
+  }
+
+  int size(){
+    return workers.size() + 1;
+  }
+
+  // Runs body(0), body(1)... body(count-1) on the threads of the pool and waits for all of them.
+  void parallelFor(int count, function<void(int)> body){
+    if(count <= 0) return;
+    if(workers.empty() || count == 1){
+      for(int i = 0; i < count; i++) body(i);
+      return;
+    }
+
+    shared_ptr<Loop> loop = make_shared<Loop>();
+    loop->body = body;
+    loop->count = count;
+    {
+      lock_guard<mutex> guard(lock);
+      loops.push_back(loop);
+    }
+    newLoop.notify_all();
+
+    runIterations(*loop);
+    unique_lock<mutex> loopLock(loop->lock);
+    loop->done.wait(loopLock, [&](){ return loop->finished == loop->count; });
+    if(loop->error) rethrow_exception(loop->error);
+  }
+
+  private:
+  void work(){
+    while(true){
+      shared_ptr<Loop> loop;
+      {
+        unique_lock<mutex> guard(lock);
+        newLoop.wait(guard, [&](){ return stopping || !loops.empty(); });
+        if(stopping) return;
+        loop = loops.front();
+        // All the iterations of the loop have started, no need to keep it.
+        if(loop->next >= loop->count){
+          loops.pop_front();
+          continue;
+        }
+      }
+      runIterations(*loop);
+    }
+  }
+
+  void runIterations(Loop &loop){
+    int i;
+    while((i = loop.next++) < loop.count){
+      try{
+        loop.body(i);
+      }catch(...){
+        lock_guard<mutex> loopLock(loop.lock);
+        if(!loop.error) loop.error = current_exception();
+      }
+      if(++loop.finished == loop.count){
+        lock_guard<mutex> loopLock(loop.lock);
+        loop.done.notify_all();
+      }
+    }
+  }
+}ThreadPool;
+
+// A gate of a FactoredNetwork: an AND (or an OR, if sum is set) of its operands.
+typedef struct FactoredGate{
+  bool sum;
+  vector<int> operands;
+}FactoredGate;
+
+/**
+ * @brief Multi-level form of the sums of products of one or several functions, to count the gates 
+ * they need when their subexpressions are shared: each negated input gets a single NOT gate, the 
+ * pairs of literals that are on several terms (of any of the functions) are built once as a common 
+ * cube, and the terms of each function are factored by their most common literal, so that a*b + a*c 
+ * becomes a*(b + c) and the quotient (b + c) is a kernel of the function. The gates are kept on a
+ * table by their operands, so a subexpression that appears several times is only built once.
+ * 
+ * The operands are literals, 2*input if the input is not negated or 2*input+1 if it is, or gates, 
+ * 2*numInputs plus the index of the gate.
+ */
+typedef struct FactoredNetwork{
+  // Operand of the functions that are always 1 or always 0.
+  static constexpr int ONE = -1;
+  static constexpr int ZERO = -2;
+
+  int numInputs;
+  vector<FactoredGate> gates;
+  // Indexes of the gates by the hash of their type and operands.
+  unordered_map<uint64_t, vector<int>> gateTable;
+  // Terms of all the functions, as sorted operands, and the function of each one.
+  vector<vector<int>> terms;
+  vector<int> termFunctions;
+  // Operand of the output of each function, once factor has been called.
+  vector<int> outputs;
+
+  FactoredNetwork(int nInp) : numInputs(nInp){}
+
+  // Adds a function given as the implicants of its sum of products.
+  template<typename Bits>
+  void addFunction(Implicants<Bits> &cover){
+    for(Implicant<Bits> &imp : cover){
+      terms.push_back(imp.getLiterals(numInputs));
+      termFunctions.push_back(outputs.size());
+    }
+    outputs.push_back(cover.empty() ? ZERO : ONE);
+  }
+
+  // Builds the gates of the functions.
+  void factor(){
+    extractCommonCubes();
+    vector<vector<vector<int>>> functionTerms(outputs.size());
+    for(size_t t = 0; t < terms.size(); t++){
+      functionTerms[termFunctions[t]].push_back(terms[t]);
+    }
+    for(size_t f = 0; f < outputs.size(); f++){
+      if(functionTerms[f].empty()) continue;
+      // A term without literals is always 1.
+      bool always = false;
+      for(vector<int> &term : functionTerms[f]){
+        if(term.empty()) always = true;
+      }
+      outputs[f] = always ? ONE : factorTerms(functionTerms[f]);
+    }
+  }
+
+  /**
+   * @brief Counts the gates that the outputs of some functions need. The gates that are shared by
+   * several of them are only counted once.
+   * 
+   * @param functions The indexes of the functions.
+   * @return int The total number of gates.
+   */
+  int getOperationCount(const vector<int> &functions, int *andCount, int *orCount, int *notCount){
+    *andCount = *orCount = *notCount = 0;
+    vector<bool> visited(gates.size(), false), negated(numInputs, false);
+    vector<int> pending;
+    for(int f : functions){
+      if(outputs[f] >= 0) pending.push_back(outputs[f]);
+    }
+    while(!pending.empty()){
+      int operand = pending.back();
+      pending.pop_back();
+      if(operand < 2*numInputs){
+        if(operand % 2 == 1 && !negated[operand/2]){
+          negated[operand/2] = true;
+          (*notCount)++;
+        }
+        continue;
+      }
+      int gate = operand - 2*numInputs;
+      if(visited[gate]) continue;
+      visited[gate] = true;
+      (gates[gate].sum ? *orCount : *andCount) += gates[gate].operands.size() - 1;
+      pending.insert(pending.end(), gates[gate].operands.begin(), gates[gate].operands.end());
+    }
+    return *andCount + *orCount + *notCount;
+  }
+
+  // Prints an operand. The literals of a product (and of the products inside it) are printed in the
+  // order of the inputs, followed by its sums between parenthesis.
+  void print(ostream &stream, int operand, bool colored, bool parenthesis = false){
+    if(operand == ONE || operand == ZERO){
+      stream << (operand == ONE ? "1" : "0");
+    }else if(operand < 2*numInputs){
+      string name = getInputName(operand/2);
+      if(colored) stream << (operand % 2 ? "\e[0;31m" : "\e[0;32m") << name << "\e[0m";
+      else stream << (operand % 2 ? "#" : "") << name;
+    }else if(gates[operand - 2*numInputs].sum){
+      FactoredGate &gate = gates[operand - 2*numInputs];
+      if(parenthesis) stream << "(";
+      for(size_t i = 0; i < gate.operands.size(); i++){
+        if(i > 0) stream << "+";
+        print(stream, gate.operands[i], colored);
+      }
+      if(parenthesis) stream << ")";
+    }else{
+      vector<int> factors, pending = {operand};
+      while(!pending.empty()){
+        int factor = pending.back();
+        pending.pop_back();
+        if(factor < 2*numInputs || gates[factor - 2*numInputs].sum) factors.push_back(factor);
+        else pending.insert(pending.end(), gates[factor - 2*numInputs].operands.begin(), 
+                            gates[factor - 2*numInputs].operands.end());
+      }
+      sort(factors.begin(), factors.end());
+      for(int factor : factors) print(stream, factor, colored, true);
+    }
+  }
+
+  private:
+  /**
+   * @param sum If the gate is an OR instead of an AND.
+   * @param operands The operands of the gate, in any order.
+   * @return int The operand of the gate with those operands, which is only created if there was none
+   * on the table. If there is only one operand, it is returned instead.
+   */
+  int getGate(bool sum, vector<int> operands){
+    sort(operands.begin(), operands.end());
+    operands.erase(unique(operands.begin(), operands.end()), operands.end());
+    if(operands.size() == 1) return operands[0];
+
+    uint64_t hash = mixHash(sum);
+    for(int operand : operands) hash = mixHash(hash ^ operand);
+    vector<int> &candidates = gateTable[hash];
+    for(int gate : candidates){
+      if(gates[gate].sum == sum && gates[gate].operands == operands) return 2*numInputs + gate;
+    }
+    candidates.push_back(gates.size());
+    gates.push_back(FactoredGate{sum, operands});
+    return 2*numInputs + gates.size() - 1;
+  }
+
+  // Repeatedly builds the pair of operands that is on the most terms as a gate, and replaces the pair
+  // by the gate on those terms, while a pair is on two terms or more.
+  void extractCommonCubes(){
+    auto pairKey = [](int a, int b){ return a < b ? ((uint64_t) a << 32) | b : ((uint64_t) b << 32) | a; };
+    // Terms of each operand. The terms are not removed from the list when they lose the operand.
+    vector<vector<int>> operandTerms(2*numInputs);
+    unordered_map<uint64_t, int> pairCounts;
+    for(size_t t = 0; t < terms.size(); t++){
+      for(size_t i = 0; i < terms[t].size(); i++){
+        operandTerms[terms[t][i]].push_back(t);
+        for(size_t j = i+1; j < terms[t].size(); j++) pairCounts[pairKey(terms[t][i], terms[t][j])]++;
+      }
+    }
+    // The counts of the queue may be outdated: the greater ones are checked against pairCounts when
+    // they are taken out of it, and each count that grows is pushed again.
+    priority_queue<pair<int, uint64_t>> queue;
+    for(auto &count : pairCounts){
+      if(count.second >= 2) queue.push({count.second, count.first});
+    }
+
+    while(!queue.empty()){
+      int count = queue.top().first;
+      uint64_t key = queue.top().second;
+      queue.pop();
+      int current = pairCounts[key];
+      if(current != count){
+        if(current >= 2 && current < count) queue.push({current, key});
+        continue;
+      }
+
+      int a = key >> 32, b = key & 0xFFFFFFFF;
+      int gate = getGate(false, {a, b});
+      operandTerms.resize(gate+1);
+      vector<int> candidates = operandTerms[a].size() < operandTerms[b].size() ? operandTerms[a] : operandTerms[b];
+      for(int t : candidates){
+        vector<int> &term = terms[t];
+        if(!binary_search(term.begin(), term.end(), a) || !binary_search(term.begin(), term.end(), b)) continue;
+        for(int operand : term){
+          if(operand != a) pairCounts[pairKey(a, operand)]--;
+          if(operand != a && operand != b) pairCounts[pairKey(b, operand)]--;
+        }
+        term.erase(remove_if(term.begin(), term.end(), [&](int operand){ return operand == a || operand == b; }), 
+                   term.end());
+        for(int operand : term){
+          int &pairCount = pairCounts[pairKey(gate, operand)];
+          if(++pairCount >= 2) queue.push({pairCount, pairKey(gate, operand)});
+        }
+        term.insert(lower_bound(term.begin(), term.end(), gate), gate);
+        operandTerms[gate].push_back(t);
+      }
+    }
+  }
+
+  /**
+   * @brief Factors a sum of terms by the operand that is on the most of them: the terms with it are 
+   * divided by their largest common cube, and the quotient and the rest of the terms are factored 
+   * the same way.
+   * 
+   * @param sum The terms, which are not empty.
+   * @return int The operand of the factored sum.
+   */
+  int factorTerms(vector<vector<int>> &sum){
+    if(sum.size() == 1) return getGate(false, sum[0]);
+
+    unordered_map<int, int> operandCounts;
+    for(vector<int> &term : sum){
+      for(int operand : term) operandCounts[operand]++;
+    }
+    int best = -1, bestCount = 1;
+    for(vector<int> &term : sum){
+      for(int operand : term){
+        if(operandCounts[operand] > bestCount){
+          best = operand;
+          bestCount = operandCounts[operand];
+        }
+      }
+    }
+    vector<int> operands;
+    if(best == -1){
+      for(vector<int> &term : sum) operands.push_back(getGate(false, term));
+      return getGate(true, operands);
+    }
+
+    vector<vector<int>> divided, rest;
+    vector<int> common;
+    for(vector<int> &term : sum){
+      if(!binary_search(term.begin(), term.end(), best)){
+        rest.push_back(term);
+      }else if(divided.empty()){
+        common = term;
+        divided.push_back(term);
+      }else{
+        vector<int> shared;
+        set_intersection(common.begin(), common.end(), term.begin(), term.end(), back_inserter(shared));
+        common = shared;
+        divided.push_back(term);
+      }
+    }
+    // If a term is the common cube, the rest of the divided terms are absorbed by it (X + XY = X).
+    bool absorbed = false;
+    for(vector<int> &term : divided){
+      vector<int> quotient;
+      set_difference(term.begin(), term.end(), common.begin(), common.end(), back_inserter(quotient));
+      if(quotient.empty()) absorbed = true;
+      term = quotient;
+    }
+    vector<int> product = common;
+    if(!absorbed) product.push_back(factorTerms(divided));
+    operands.push_back(getGate(false, product));
+
+    if(!rest.empty()){
+      int restOperand = factorTerms(rest);
+      if(restOperand >= 2*numInputs && gates[restOperand - 2*numInputs].sum){
+        vector<int> &restOperands = gates[restOperand - 2*numInputs].operands;
+        operands.insert(operands.end(), restOperands.begin(), restOperands.end());
+      }else operands.push_back(restOperand);
+    }
+    return getGate(true, operands);
+  }
+}FactoredNetwork;
+
+/**
+ * @brief Result of a function for the writers of the output formats (see writeResults): the literals 
+ * of each product term of its sum of products (see Implicant::getLiterals) and its gates. A function 
+ * without terms is always 0, and a term without literals is always 1.
+ */
+typedef struct FunctionResult{
+  string name;
+  vector<vector<int>> terms;
+  int andCount = 0;
+  int orCount = 0;
+  int notCount = 0;
+  bool optimal = true;
+}FunctionResult;
+
+// @return The cube of a product term as on the rows of PLA: '1' or '0' on the inputs of its literals
+// and '-' on the others, from the first input.
+string getTermCube(const vector<int> &term, int numInputs){
+  string cube(numInputs, '-');
+  for(int literal : term) cube[literal/2] = literal % 2 == 0 ? '1' : '0';
+  return cube;
+}
+
+// Writes the functions as a table of Berkeley PLA. The product terms that are shared by several
+// functions (as with -m) are a single row with a 1 on each of them.
+void writePLA(ostream &stream, int numInputs, const vector<FunctionResult> &results){
+  vector<string> cubes, outputs;
+  unordered_map<string, int> rows;
+  for(size_t f = 0; f < results.size(); f++){
+    for(const vector<int> &term : results[f].terms){
+      auto row = rows.emplace(getTermCube(term, numInputs), cubes.size());
+      if(row.second){
+        cubes.push_back(row.first->first);
+        outputs.push_back(string(results.size(), '0'));
+      }
+      outputs[row.first->second][f] = '1';
+    }
+  }
+
+  stream << ".i " << numInputs << "\n.o " << results.size() << "\n.ilb";
+  for(int i = 0; i < numInputs; i++) stream << " " << getInputName(i);
+  stream << "\n.ob";
+  for(const FunctionResult &result : results) stream << " " << result.name;
+  stream << "\n.p " << cubes.size() << "\n";
+  for(size_t row = 0; row < cubes.size(); row++){
+    stream << cubes[row] << " " << outputs[row] << "\n";
+  }
+  stream << ".e\n";
+}
+
+// Writes the functions as a Verilog module, with an input port for each input and an output port
+// with an assign statement for each function.
+void writeVerilog(ostream &stream, int numInputs, const vector<FunctionResult> &results){
+  stream << "module petrick(";
+  for(int i = 0; i < numInputs; i++) stream << (i > 0 ? ", " : "") << "input " << getInputName(i);
+  for(const FunctionResult &result : results) stream << ", output " << result.name;
+  stream << ");\n";
+  for(const FunctionResult &result : results){
+    stream << "  assign " << result.name << " = ";
+    if(result.terms.empty()) stream << "1'b0";
+    for(size_t t = 0; t < result.terms.size(); t++){
+      const vector<int> &term = result.terms[t];
+      if(t > 0) stream << " | ";
+      if(term.empty()) stream << "1'b1";
+      bool parenthesis = term.size() > 1 && result.terms.size() > 1;
+      if(parenthesis) stream << "(";
+      for(size_t l = 0; l < term.size(); l++){
+        stream << (l > 0 ? " & " : "") << (term[l] % 2 == 1 ? "~" : "") << getInputName(term[l]/2);
+      }
+      if(parenthesis) stream << ")";
+    }
+    stream << ";\n";
+  }
+  stream << "endmodule\n";
+}
+
+// Writes a JSON line for each function, with its product terms as the cubes of PLA, its expression as
+// on the text format and its gates.
+void writeJSON(ostream &stream, int numInputs, const vector<FunctionResult> &results){
+  for(const FunctionResult &result : results){
+    stream << "{\"function\": \"" << result.name << "\", \"inputs\": " << numInputs << ", \"terms\": [";
+    for(size_t t = 0; t < result.terms.size(); t++){
+      stream << (t > 0 ? ", \"" : "\"") << getTermCube(result.terms[t], numInputs) << "\"";
+    }
+    stream << "], \"expression\": \"";
+    if(result.terms.empty()) stream << "0";
+    for(size_t t = 0; t < result.terms.size(); t++){
+      if(t > 0) stream << "+";
+      if(result.terms[t].empty()) stream << "1";
+      for(int literal : result.terms[t]){
+        stream << (literal % 2 == 1 ? "#" : "") << getInputName(literal/2);
+      }
+    }
+    stream << "\", \"operations\": " << result.andCount + result.orCount + result.notCount
+           << ", \"and\": " << result.andCount << ", \"or\": " << result.orCount << ", \"not\": " 
+           << result.notCount << ", \"optimal\": " << (result.optimal ? "true" : "false") << "}\n";
+  }
+}
+
+/**
+ * @brief Writes the results of a group of functions of the same inputs with one of the formats other
+ * than text. The output is built on a buffer and written to the stream at once, so that the large 
+ * groups (and the many lines of --batch) don't write it piece by piece.
+ * 
+ * @param stream Where the results are written.
+ * @param format The format of the results.
+ * @param numInputs The number of inputs of the functions.
+ * @param results The results of the functions.
+ */
+void writeResults(ostream &stream, OutputFormat format, int numInputs, const vector<FunctionResult> &results){
+  ostringstream buffer;
+  if(format == FORMAT_PLA) writePLA(buffer, numInputs, results);
+  else if(format == FORMAT_VERILOG) writeVerilog(buffer, numInputs, results);
+  else if(format == FORMAT_JSON) writeJSON(buffer, numInputs, results);
+  string text = buffer.str();
+  stream.write(text.data(), text.size());
+}
+
+/**
+ * @brief Counters and time of the stages of the minimization of a function, which are printed as a
+ * JSON line with --stats. The counters are always kept, as they are only updated once per pair of 
+ * buckets or per multiplication; the stages are only timed with --stats.
+ */
+typedef struct FunctionStats{
+  // Pairs of implicants compared while building the prime implicants (each implicant of a bucket with 
+  // all the ones of the next bucket), and the pairs that were joined.
+  uint64_t joinAttempts = 0;
+  uint64_t joinSuccesses = 0;
+  // Joined implicants that were already on the list, found several times from different pairs.
+  uint64_t duplicateJoins = 0;
+  uint64_t primeCount = 0;
+  // Nodes of the decision diagrams that the prime implicants were calculated from (with --bdd).
+  uint64_t bddNodes = 0;
+  // Most products of Petrick's method (on the mult loop) or nodes of the branch and bound search.
+  uint64_t peakProducts = 0;
+  uint64_t searchNodes = 0;
+  // Passes of X + XY = X over the products of Petrick's method.
+  uint64_t absorptionPasses = 0;
+  // Bytes allocated for the products of Petrick's method.
+  uint64_t allocatedBytes = 0;
+  // Solver that covered the rows and columns that remained on the chart after taking out the essential
+  // and dominated ones (its cyclic core), which the auto solver chooses by their number. It is bnb when
+  // the ilp solver stopped without a cover, and "none" when no solver ran (e.g. the core was empty, or
+  // the result was read from the cache).
+  string coverSolver = "none";
+  uint64_t coreRows = 0;
+  uint64_t coreColumns = 0;
+  // If the result was read from the cache (see Function::loadCachedResult).
+  bool cacheHit = false;
+  // If the time or the memory limit was hit (see Budget).
+  bool budgetExceeded = false;
+  // Milliseconds of each stage, in the order they were run.
+  vector<pair<string, double>> stageTimes;
+
+  void addTime(const string &stage, double milliseconds){
+    for(pair<string, double> &time : stageTimes){
+      if(time.first == stage){
+        time.second += milliseconds;
+        return;
+      }
+    }
+    stageTimes.push_back({stage, milliseconds});
+  }
+
+  void print(ostream &stream, const string &funcName, int numInputs){
+    stream << "{\"function\": \"" << funcName << "\", \"inputs\": " << numInputs << ", \"stages\": {";
+    for(size_t i = 0; i < stageTimes.size(); i++){
+      stream << (i > 0 ? ", \"" : "\"") << stageTimes[i].first << "\": " << stageTimes[i].second;
+    }
+    stream << "}, \"joinAttempts\": " << joinAttempts << ", \"joinSuccesses\": " << joinSuccesses
+           << ", \"duplicateJoins\": " << duplicateJoins << ", \"primes\": " << primeCount
+           << ", \"bddNodes\": " << bddNodes
+           << ", \"coverSolver\": \"" << coverSolver << "\", \"coreRows\": " << coreRows 
+           << ", \"coreColumns\": " << coreColumns
+           << ", \"peakProducts\": " << peakProducts << ", \"searchNodes\": " << searchNodes
+           << ", \"absorptionPasses\": " << absorptionPasses << ", \"allocatedBytes\": " << allocatedBytes 
+           << ", \"cacheHit\": " << (cacheHit ? "true" : "false") 
+           << ", \"budgetExceeded\": " << (budgetExceeded ? "true" : "false") << "}" << endl;
+  }
+}FunctionStats;
+
+// Memory resource that counts the bytes allocated from another one, for FunctionStats::allocatedBytes,
+// and the ones that are still allocated, for Budget.
+typedef struct CountingResource : pmr::memory_resource{
+  pmr::memory_resource *upstream;
+  uint64_t allocatedBytes = 0;
+  uint64_t currentBytes = 0;
+
+  CountingResource(pmr::memory_resource *resource = pmr::get_default_resource()) : upstream(resource){}
+
+  private:
+  void* do_allocate(size_t bytes, size_t alignment) override{
+    allocatedBytes += bytes;
+    currentBytes += bytes;
+    return upstream->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *pointer, size_t bytes, size_t alignment) override{
+    currentBytes -= bytes;
+    upstream->deallocate(pointer, bytes, alignment);
+  }
+
+  bool do_is_equal(const pmr::memory_resource &other) const noexcept override{
+    return this == &other;
+  }
+}CountingResource;
+
+template<typename Bits>
+struct Function{
+  template<typename> friend struct MultiFunction;
+  // Runs the stages of reduce one by one to time them (see benchmark.cpp).
+  friend struct Benchmark;
+
+  Implicants<Bits> originalFunction;
+  Implicants<Bits> imps;
+  // Keys (Implicant::getKey) of all the implicants inside imps, to know if an implicant is already on the list.
+  typename Implicant<Bits>::KeySet impsKeys;
+  // Number of inputs
+  int numInputs;
+  string funcName;
+  // Where the results (and the verbose information) are printed. If null, nothing is printed.
+  ostream *output = &cout;
+  // Threads used to join the implicants. If zero, they are joined on the calling thread.
+  ThreadPool *pool = 0;
+  Options options = DEFAULT_OPTIONS;
+  // Implicants of the last result and its number of gates, which are kept even if output is null (as
+  // it is on the library, see petrick.h).
+  Implicants<Bits> resultCover;
+  int resultAnd = 0, resultOr = 0, resultNot = 0;
+  // False if the result may not be the one with the least number of operations, because some partial 
+  // products were pruned (see Options::maxProducts and Options::costLimit) or because it was found by a heuristic.
+  bool provenOptimal = true;
+  FunctionStats stats;
+  // With a format other than text, the stats line is kept until the result is written after it (see 
+  // writeFunctionResults).
+  string statsLine;
+  // Limits of the time and the memory of the current reduce, from the options.
+  Budget budget;
+  // File of the cache where the result is stored when it is printed (see findCacheFile). Empty if the
+  // result is not stored.
+  string cacheFile;
+  // Inputs of the function on the order of its canonical form: the input k of the canonical form is 
+  // the input canonicalInputs[k] of the function.
+  vector<int> canonicalInputs;
+  // If imps are the prime implicants of the function, which are then updated by setMinterm.
+  bool primesCalculated = false;
+  // Keys of the implicants of the last result, where the next search starts from (see setMinterm).
+  typename Implicant<Bits>::KeySet previousCover;
+  
+  // The minterms and Do-Not-Care bits of the function given as cubes, which may group many minterms.
+  Implicants<Bits> onSet;
+  Implicants<Bits> dncSet;
+  // Bitmaps of the minterms (onBitmap) and Do-Not-Care bits (dncBitmap) of the function: the bit m of 
+  // the word m/64 is set if m belongs to the set. They are filled by expandFunction.
+  vector<uint64_t> onBitmap;
+  vector<uint64_t> dncBitmap;
+  
+  Function(Implicants<Bits> m, Implicants<Bits> dnc, int nInp, string name) : numInputs(nInp), funcName(name), 
+                                                                  onSet(m), dncSet(dnc){}
+
+  Function(Minterms<Bits> m, Minterms<Bits> dnc, int nInp, string name) : numInputs(nInp), funcName(name){
+    for(Minterm<Bits> min : m) onSet.push_back(min);
+    for(Minterm<Bits> min : dnc) dncSet.push_back(min);
+  }
+
+  void reduce(){
+    provenOptimal = true;
+    budget = Budget(options);
+    resultCover.clear();
+    resultAnd = resultOr = resultNot = 0;
+    if(options.solver == SOLVER_ESPRESSO){
+      // The cubes are minimized directly, without listing their minterms.
+      timeStage("espresso", [&](){
+        Espresso<Bits> espresso(onSet, dncSet, numInputs);
+        espresso.budget = &budget;
+        imps = espresso.minimize();
+      });
+      primesCalculated = false;
+      stats.primeCount = imps.size();
+      provenOptimal = false;
+      vector<Implicant<Bits>*> cover;
+      for(size_t i = 0; i < imps.size(); i++){
+        cover.push_back(&imps[i]);
+      }
+      ImplicantOperation<Bits> result = ImplicantOperation<Bits>::productOf(cover);
+      printResult(result);
+      printStats();
+      return;
+    }
+
+    if(!options.bddPrimes) timeStage("expandFunction", [&](){ expandFunction(); });
+    if(options.bddPrimes){
+      // The cache is not used, as originalFunction only gets the minterms of the function.
+      cacheFile.clear();
+      imps.clear();
+      impsKeys.clear();
+      timeStage("bddPrimes", [&](){ calculatePrimesBDD(); });
+      primesCalculated = false;
+      if(imps.empty()){
+        printEmptyResult();
+        printStats();
+        return;
+      }
+    }else if(primesCalculated){
+      // The prime implicants were kept up to date by setMinterm, so only the chart is solved again.
+      if(!options.cachePath.empty()) findCacheFile();
+      if(imps.empty()){
+        printEmptyResult();
+        cacheFile.clear();
+        printStats();
+        return;
+      }
+    }else{
+      if(!options.cachePath.empty()){
+        timeStage("cache", [&](){ stats.cacheHit = loadCachedResult(); });
+        if(stats.cacheHit){
+          printStats();
+          return;
+        }
+      }
+      imps.clear();
+      impsKeys.clear();
+      calculateImplicants();
+      timeStage("removeNonEssentialImplicants", [&](){ removeNonEssentialImplicants(); });
+      // If the joins were stopped by the budget, imps are a cover but not all of them are prime.
+      primesCalculated = !budget.exceeded;
+    }
+    if(options.verbose){
+      nameImplicants();
+    }
+    timeStage("petrick", [&](){ petrick(); });
+    printStats();
+  }
+
+  /**
+   * @brief Adds m to the minterms of the function or, if dnc is true, to its Do-Not-Care bits. If m
+   * was already on the other set, it is moved. After the function has been reduced, only the prime 
+   * implicants that contain m are updated, and the next reduce solves the chart again starting from 
+   * the previous result (with the bnb solver).
+   * 
+   * @param m The minterm.
+   * @param dnc If m is a Do-Not-Care bit.
+   */
+  void addMinterm(Bits m, bool dnc = false){
+    setMinterm(m, dnc ? 1 : 0);
+  }
+
+  // Removes m from the minterms or the Do-Not-Care bits of the function, as addMinterm.
+  void removeMinterm(Bits m){
+    setMinterm(m, -1);
+  }
+
+  // Fills originalFunction with the minterms of the cubes of the function.
+  void expandFunction(){
+    if(!onBitmap.empty()) return;
+    if(numInputs > MAX_EXPANDED_INPUTS){
+      throw invalid_argument("Functions of more than " + to_string(MAX_EXPANDED_INPUTS) + 
+                             " inputs can only be minimized with the espresso solver");
+    }
+
+    // Mark the minterms of the cubes on the bitmaps, which also removes the repeated ones.
+    size_t wordCount = ((1ull << numInputs) + 63) / 64;
+    onBitmap.assign(wordCount, 0);
+    dncBitmap.assign(wordCount, 0);
+    for(Implicant<Bits> &cube : onSet){
+      cube.forEachMinterm([&](Bits m){ onBitmap[lowBits(m)/64] |= 1ull << (lowBits(m)%64); });
+    }
+    for(Implicant<Bits> &cube : dncSet){
+      cube.forEachMinterm([&](Bits m){ dncBitmap[lowBits(m)/64] |= 1ull << (lowBits(m)%64); });
+    }
+
+    // Put both minterms inside the implicant function as separate implicants but in order.
+    originalFunction.clear();
+    for(size_t w = 0; w < wordCount; w++){
+      if(onBitmap[w] & dncBitmap[w]){
+        throw invalid_argument("Input of two minterms as Do not care and Do care");
+      }
+      for(uint64_t word = onBitmap[w] | dncBitmap[w]; word != 0; word &= word - 1){
+        int bit = __builtin_ctzll(word);
+        Implicant<Bits> tempImp(Minterm<Bits>(Bits(64*w + bit)));
+        if((dncBitmap[w]>>bit)&0x01){
+          tempImp.value.dnc = true;
+          tempImp.essential = false;
+        }
+        originalFunction.push_back(tempImp);
+      }
+    }
+  }
+
+  // Prints the result of a function without minterms, which is always 0.
+  void printEmptyResult(){
+    if(output && options.format == FORMAT_TEXT) *output << funcName << ": 0" << endl;
+  }
+
+  // @return The last result, for the writers of the formats other than text (see writeResults).
+  FunctionResult getResult(){
+    FunctionResult result;
+    result.name = funcName;
+    for(Implicant<Bits> &imp : resultCover){
+      result.terms.push_back(imp.getLiterals(numInputs));
+    }
+    result.andCount = resultAnd;
+    result.orCount = resultOr;
+    result.notCount = resultNot;
+    result.optimal = provenOptimal;
+    return result;
+  }
+
+  void printTruthTable(){
+      expandFunction();
+      for(int i = 0; i < numInputs; i++){
+          *output << getInputName(i);
+      }
+      *output << "  " << funcName << endl;
+
+      for(int i = 0; i < (1<<numInputs); i++){
+          for(int j = numInputs-1; j >= 0; j--){
+              if(i&(1<<j)){
+                  *output << '1';
+              }else{
+                  *output << '0';
+              }
+          }
+
+          *output << "  ";
+          int search = searchMinterm(i);
+          if(search == 0){
+              *output << '1';
+          }else if(search == 1){
+              *output << 'x';
+          }else{
+              *output << '0';
+          }
+          *output << endl;
+      }
+  }
+
+  private:
+  // Runs body and, with --stats, adds its time to the stage of the stats.
+  template<typename Body>
+  void timeStage(const char *stage, Body body){
+    if(!options.stats){
+      body();
+      return;
+    }
+    auto start = chrono::steady_clock::now();
+    body();
+    stats.addTime(stage, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+  }
+
+  // With --stats, prints the stats of the last reduce, which are then cleared for the next one.
+  void printStats(){
+    if(options.stats && output){
+      if(options.format == FORMAT_TEXT){
+        stats.print(*output, funcName, numInputs);
+      }else{
+        ostringstream line;
+        stats.print(line, funcName, numInputs);
+        statsLine = line.str();
+      }
+    }
+    stats = FunctionStats();
+  }
+
+  /**
+   * @brief Changes the set of the minterm m: 0 for the minterms, 1 for the Do-Not-Care bits and -1 for
+   * neither of them (as searchMinterm). If the prime implicants were already calculated, they are only 
+   * updated around m. The prime implicants are the largest cubes inside the minterms and Do-Not-Care 
+   * bits of the function that have a minterm, so:
+   * - When m is added, the new ones are the largest cubes that contain m, and the old ones inside 
+   *   them are not prime anymore.
+   * - When m is removed, the ones that contain m are removed. Any new one is inside one of those and
+   *   does not contain m, so it is the half of one of them on the other side of one of the inputs.
+   * - When m moves between the minterms and the Do-Not-Care bits, only the cubes with m may gain or 
+   *   lose their minterms.
+   * 
+   * Besides the prime implicants around m, each call goes through the cubes of onSet and dncSet, and 
+   * moves the minterms after m on the sorted originalFunction, which are at most 2^numInputs.
+   */
+  void setMinterm(Bits m, int state){
+    expandFunction();
+    uint64_t index = lowBits(m);
+    if(!(m == Bits(index)) || index >= (1ULL << numInputs)){
+      throw invalid_argument("The minterm is greater than the largest one of " + to_string(numInputs) + " inputs.");
+    }
+    int previous = searchMinterm(index);
+    if(previous == state) return;
+
+    timeStage("setMinterm", [&](){
+      // The largest cubes with m before it leaves the function, whose halves may be new prime implicants.
+      Implicants<Bits> removedCubes;
+      if(primesCalculated && state == -1) findLargestCubes(m, removedCubes);
+
+      uint64_t bit = 1ULL << (index%64);
+      onBitmap[index/64] &= ~bit;
+      dncBitmap[index/64] &= ~bit;
+      if(state == 0) onBitmap[index/64] |= bit;
+      if(state == 1) dncBitmap[index/64] |= bit;
+
+      // originalFunction is kept sorted.
+      auto position = lower_bound(originalFunction.begin(), originalFunction.end(), index, 
+                                  [](Implicant<Bits> &i, uint64_t value){ return lowBits(i.value.val) < value; });
+      if(state == -1){
+        originalFunction.erase(position);
+      }else{
+        if(previous == -1) position = originalFunction.insert(position, Implicant<Bits>(Minterm<Bits>(m)));
+        position->value.dnc = state == 1;
+        position->essential = state == 0;
+      }
+      // Only the cubes of the function with m change, so that they match the bitmaps.
+      if(previous != -1) removeFromCubes(previous == 0 ? onSet : dncSet, m);
+      if(state != -1) (state == 0 ? onSet : dncSet).push_back(Implicant<Bits>(Minterm<Bits>(m)));
+      if(!primesCalculated) return;
+
+      // Remove the prime implicants that are not prime anymore.
+      Implicants<Bits> addedCubes;
+      if(state == -1){
+        removePrimes([&](Implicant<Bits> &imp){ return imp.covers(Minterm<Bits>(m)); });
+        for(Implicant<Bits> &cube : removedCubes){
+          for(int input = 0; input < numInputs; input++){
+            if((cube.commonBitsMask.val >> input) & Bits(1)) continue;
+            Bits half = Bits(1) << input;
+            addedCubes.push_back(Implicant<Bits>((m & cube.commonBitsMask.val) | (~m & half), 
+                                                 cube.commonBitsMask.val | half, numInputs));
+          }
+        }
+      }else if(previous == -1){
+        findLargestCubes(m, addedCubes);
+        removePrimes([&](Implicant<Bits> &imp){
+          for(Implicant<Bits> &cube : addedCubes){
+            if(cube.covers(imp.value) && (cube.commonBitsMask.val & ~imp.commonBitsMask.val) == Bits(0)) return true;
+          }
+          return false;
+        });
+      }else{
+        removePrimes([&](Implicant<Bits> &imp){ return imp.covers(Minterm<Bits>(m)) && !hasMinterm(imp); });
+        if(state == 0) findLargestCubes(m, addedCubes);
+      }
+
+      for(Implicant<Bits> &cube : addedCubes){
+        if(!hasMinterm(cube) || !isLargestCube(cube)) continue;
+        if(impsKeys.insert(cube.getKey()).second) imps.push_back(cube);
+      }
+    });
+  }
+
+  /**
+   * @brief Takes m out of the cubes. Each cube with m is replaced by a cube for each of its free 
+   * inputs: the part of it on the other side of that input than m, and on the side of m of the free 
+   * inputs before it. Those cubes have each of the other minterms of the cube once.
+   * 
+   * @param cubes The cubes, e.g. onSet.
+   * @param m The minterm.
+   */
+  void removeFromCubes(Implicants<Bits> &cubes, Bits m){
+    Implicants<Bits> parts;
+    auto split = [&](Implicant<Bits> &cube){
+      if(!cube.covers(Minterm<Bits>(m))) return false;
+      Bits mask = cube.commonBitsMask.val;
+      for(int input = 0; input < numInputs; input++){
+        if((mask >> input) & Bits(1)) continue;
+        Bits bit = Bits(1) << input;
+        parts.push_back(Implicant<Bits>((m & mask) | (~m & bit), mask | bit, numInputs));
+        mask = mask | bit;
+      }
+      return true;
+    };
+    cubes.erase(remove_if(cubes.begin(), cubes.end(), split), cubes.end());
+    cubes.insert(cubes.end(), parts.begin(), parts.end());
+  }
+
+  // @return true if all the minterms of the cube are minterms or Do-Not-Care bits of the function.
+  bool isInside(Implicant<Bits> &cube){
+    bool inside = true;
+    cube.forEachMinterm([&](Bits x){ if(inside && searchMinterm(lowBits(x)) == -1) inside = false; });
+    return inside;
+  }
+
+  // @return true if the cube has a minterm of the function (not a Do-Not-Care one).
+  bool hasMinterm(Implicant<Bits> &cube){
+    bool found = false;
+    cube.forEachMinterm([&](Bits x){ if(!found && searchMinterm(lowBits(x)) == 0) found = true; });
+    return found;
+  }
+
+  // @return true if the cube is inside the function and cannot be grown on any of its inputs.
+  bool isLargestCube(Implicant<Bits> &cube){
+    if(!isInside(cube)) return false;
+    for(int input = 0; input < numInputs; input++){
+      Bits bit = Bits(1) << input;
+      if(!((cube.commonBitsMask.val >> input) & Bits(1))) continue;
+      Implicant<Bits> neighbour(cube.value.val ^ bit, cube.commonBitsMask.val, numInputs);
+      if(isInside(neighbour)) return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Finds all the largest cubes inside the minterms and Do-Not-Care bits of the function that
+   * contain m. The cubes are grown from m one input at a time, as a cube can only be inside the 
+   * function if the two halves of it on any of its inputs are.
+   * 
+   * @param m The minterm, which must be a minterm or a Do-Not-Care bit of the function.
+   * @param cubes Output list of cubes.
+   */
+  void findLargestCubes(Bits m, Implicants<Bits> &cubes){
+    auto grow = [&](auto &grow, Implicant<Bits> &cube, int firstInput) -> void{
+      bool largest = true;
+      for(int input = 0; input < numInputs; input++){
+        Bits bit = Bits(1) << input;
+        if(!((cube.commonBitsMask.val >> input) & Bits(1))) continue;
+        // The cube grown on the input is inside the function if its other half is.
+        Implicant<Bits> half(cube.value.val ^ bit, cube.commonBitsMask.val, numInputs);
+        if(!isInside(half)) continue;
+        largest = false;
+        // Each cube is only grown from the one without its last input, so it is visited once.
+        if(input < firstInput) continue;
+        Implicant<Bits> grown(cube.value.val, cube.commonBitsMask.val & ~bit, numInputs);
+        grow(grow, grown, input+1);
+      }
+      if(largest) cubes.push_back(cube);
+    };
+    Implicant<Bits> point(m, ~Bits(0), numInputs);
+    grow(grow, point, 0);
+  }
+
+  // Removes the prime implicants where remove(imp) is true.
+  template<typename Predicate>
+  void removePrimes(Predicate remove){
+    auto end = remove_if(imps.begin(), imps.end(), [&](Implicant<Bits> &imp){
+      if(!remove(imp)) return false;
+      impsKeys.erase(imp.getKey());
+      return true;
+    });
+    imps.erase(end, imps.end());
+  }
+
+  void petrick(){
+    if(options.solver == SOLVER_TREE){
+      stats.coverSolver = SOLVER_NAMES[SOLVER_TREE];
+      if(petrickTree()) return;
+    }
+
+    // Take the essential prime implicants out of the chart and remove its dominated rows and columns.
+    vector<Minterms<Bits>> outputMinterms(1);
+    for(Implicant<Bits> &i : originalFunction){
+      if(!i[0].dnc) outputMinterms[0].push_back(i[0]);
+    }
+    PrimeChart chart(imps, outputMinterms, numInputs);
+    chart.reduce(&budget);
+    vector<int> cover;
+    for(int row : chart.selectedRows){
+      cover.push_back(chart.rowImplicants[row]);
+    }
+
+    if(options.verbose){
+      *output << "Essential: ";
+      for(int index : cover) imps[index].print(*output);
+      *output << endl;
+    }
+
+    // Cover what remains of the chart (its cyclic core).
+    SolverType solver = options.solver == SOLVER_AUTO ? chooseCoverSolver(chart) : options.solver;
+    if(budget.exceeded) solver = SOLVER_BNB;
+    stats.coreRows = chart.getActiveRows().size();
+    stats.coreColumns = chart.getActiveColumns().size();
+    vector<int> rows;
+    if(solver == SOLVER_GREEDY){
+      bool optimal;
+      BranchAndBound search(chart);
+      search.budget = &budget;
+      rows = search.solveGreedy(optimal);
+      if(!optimal) provenOptimal = false;
+    }else if(solver == SOLVER_SOP){
+      rows = petrickCore(chart);
+    }else if(solver == SOLVER_BNB || !ilpCover(chart, rows)){
+      // After a change of the function, the search starts from the implicants of the last result (or, 
+      // if the tree solver hit the budget, from the cheapest term it found). It is also used when the
+      // ilp solver stops without a result.
+      solver = SOLVER_BNB;
+      vector<int> startRows;
+      for(int row : chart.getActiveRows()){
+        if(previousCover.count(imps[chart.rowImplicants[row]].getKey())) startRows.push_back(row);
+      }
+      rows = searchCover(chart, startRows);
+    }
+    stats.coverSolver = stats.coreColumns == 0 ? "none" : SOLVER_NAMES[solver];
+    for(int row : rows){
+      cover.push_back(chart.rowImplicants[row]);
+    }
+
+    sort(cover.begin(), cover.end());
+    vector<Implicant<Bits>*> product;
+    for(int index : cover){
+      product.push_back(&imps[index]);
+    }
+    ImplicantOperation<Bits> result = ImplicantOperation<Bits>::productOf(product);
+    printResult(result);
+  }
+
+  /**
+   * @brief Searches the cheapest cover of the rows and columns that remain on the chart with 
+   * BranchAndBound. Once the budget has been hit, it only returns the cheapest of the greedy cover and 
+   * of startRows completed by the greedy cover.
+   * 
+   * @param chart The reduced prime implicant chart.
+   * @param startRows Rows where the search starts from, which may not cover the chart.
+   * @return vector<int> The rows of the cover.
+   */
+  vector<int> searchCover(PrimeChart &chart, vector<int> &startRows){
+    BranchAndBound search(chart);
+    search.startRows = startRows;
+    search.budget = &budget;
+    vector<int> rows = search.solve();
+    stats.searchNodes += search.searchNodes;
+    return rows;
+  }
+
+  /**
+   * @brief Solves the cover of the chart with IlpCover, if petrick was built with Z3.
+   * 
+   * @param chart The reduced prime implicant chart.
+   * @param rows Gets the rows of the cheapest cover.
+   * @return false if the cover was not found (e.g. at the time limit), so another solver must be used.
+   */
+  bool ilpCover([[maybe_unused]] PrimeChart &chart, [[maybe_unused]] vector<int> &rows){
+#ifdef PETRICK_Z3
+    IlpCover ilp(chart);
+    ilp.budget = &budget;
+    return ilp.solve(rows);
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * @brief Petrick's method on the rows and columns that remain on the chart.
+   * 
+   * @param chart The reduced prime implicant chart.
+   * @return vector<int> The rows of the chart on the product of least number of operations.
+   */
+  vector<int> petrickCore(PrimeChart &chart){
+    vector<int> cover;
+    vector<int> columns = chart.getActiveColumns();
+    if(columns.empty()) return cover;
+
+    // Rows are renamed to go from zero to the number of rows that remain. 
+    vector<int> rows = chart.getActiveRows();
+    vector<int> rowIndexes(chart.rowImplicants.size());
+    vector<int> implicantCosts;
+    vector<int> implicantIndexes;
+    for(size_t i = 0; i < rows.size(); i++){
+      rowIndexes[rows[i]] = i;
+      implicantCosts.push_back(chart.rowCosts[rows[i]]);
+      implicantIndexes.push_back(chart.rowImplicants[rows[i]]);
+    }
+
+    // Operations of the rows that are already selected, with the OR that joins each one to the rest.
+    int baseCost = 0;
+    for(int row : chart.selectedRows){
+      baseCost += chart.rowCosts[row] + 1;
+    }
+    // Lowest cost of the products removed by prune.
+    int prunedCost = INT_MAX;
+
+    // From the prime implicant chart, we shall group the implicants that share the same minterm value,
+    // and multiply all those sums.
+    SumOfProducts mult(rows.size());
+    mult.budget = &budget;
+    for(int column : columns){
+      vector<int> sum;
+      for(int row : chart.columnRows[column]){
+        sum.push_back(rowIndexes[row]);
+      }
+      // Each product may be multiplied by each implicant of the sum before the absorptions.
+      if(budget.check(mult.words.size()*sizeof(uint64_t)*(sum.size()+1))){
+        // Complete the cheapest product of the columns multiplied until now with the greedy cover.
+        vector<int> startRows;
+        for(int index : mult.getImplicants(mult.getCheapest(implicantCosts))){
+          startRows.push_back(rows[index]);
+        }
+        recordProducts(mult);
+        return searchCover(chart, startRows);
+      }
+      mult.multiply(sum);
+      if(options.maxProducts > 0 || options.costLimit >= 0){
+        prunedCost = min(prunedCost, mult.prune(implicantCosts, baseCost, options.maxProducts, options.costLimit));
+      }
+      if(options.verbose){
+        mult.print(*output, imps, implicantIndexes);
+        *output << endl << "****************" << endl;
+      }
+    }
+
+    if(options.verbose){
+      *output << "SIZE:" << mult.size() << endl;
+    }
+    recordProducts(mult);
+
+    // Select the product with the least number of operations.
+    int leastOperationIndex = mult.getCheapest(implicantCosts);
+    int leastOperationCount = mult.getOperationCount(leastOperationIndex, implicantCosts);
+
+    for(int index : mult.getImplicants(leastOperationIndex)){
+      cover.push_back(rows[index]);
+    }
+    // A removed product could have given a cheaper cover.
+    if(baseCost + leastOperationCount > prunedCost) provenOptimal = false;
+    return cover;
+  }
+
+  // Adds the counters of the products of Petrick's method to the stats.
+  void recordProducts(SumOfProducts &mult){
+    stats.peakProducts = max<uint64_t>(stats.peakProducts, mult.peakSize);
+    stats.absorptionPasses += mult.absorptionPasses;
+    stats.allocatedBytes += mult.allocatedBytes;
+  }
+
+  /**
+   * @brief Petrick's method done by algebraically expanding the product of sums with ImplicantOperation.
+   * @return false if the budget was hit before the end of the expansion. Then, previousCover has the
+   * implicants of the cheapest term found until then, which petrick completes with the greedy cover.
+   */
+  bool petrickTree(){
+    // All the operations of the expansion are allocated from this arena, which reuses the memory of 
+    // the discarded ones and frees everything at once when the function returns.
+    CountingResource counter;
+    pmr::unsynchronized_pool_resource arena(&counter);
+    typename ImplicantOperation<Bits>::allocator_type alloc(&arena);
+
+    // Convert implicants to operations.
+    pmr::vector<ImplicantOperation<Bits>> ops(alloc);
+    for(size_t i = 0; i < imps.size(); i++){
+      ops.emplace_back(&imps[i]);
+    }
+
+    // Lowest cost of the terms removed by pruneTerms.
+    int prunedCost = INT_MAX;
+
+    // From the prime implicant chart, we shall group the implicants that share the same minterm value.
+    ImplicantOperation<Bits> mult(alloc);
+    for(Implicant<Bits> i : originalFunction){
+      Minterm<Bits> min = i[0];
+      if(min.dnc) continue;  // If it is a DNC, no need to add it.
+
+      ImplicantOperation<Bits> sum(alloc);
+      // All implicants...
+      for(const ImplicantOperation<Bits> &op : ops){
+        // If the implicant contains the minterm.
+        if(op.imp->covers(min)){
+          sum += op;
         }
       }
-      mult.operators[leastOperationIndex].printAlgebraic(numInputs);
-    }else{
-      leastOperationCount = mult.getOperationCount(numInputs, &andCount, &orCount, &notCount);
-      mult.printAlgebraic(numInputs);
+      // Each term of mult may be multiplied by each implicant of the sum.
+      if(budget.check(counter.currentBytes*max<size_t>(1, sum.operators.size()))){
+        int cost;
+        vector<Implicant<Bits>*> cover;
+        collectImplicants(cheapestTerm(mult, cost), cover);
+        previousCover.clear();
+        for(Implicant<Bits> *imp : cover) previousCover.insert(imp->getKey());
+        stats.allocatedBytes += counter.allocatedBytes;
+        return false;
+      }
+      if(options.verbose) sum.print(*output);
+      mult *= sum;
+      stats.peakProducts = max<uint64_t>(stats.peakProducts, mult.operators.size());
+      if(options.verbose){
+        *output<<endl;
+        mult.print(*output);
+        *output<<endl<<"****************"<<endl;
+      }
+      mult.levelParenthesis();
+      // Simplify till no changes are made.
+      do stats.absorptionPasses++; while(mult.applySumAbsortion());
+      if(options.maxProducts > 0 || options.costLimit >= 0){
+        prunedCost = std::min(prunedCost, mult.pruneTerms(numInputs, options.maxProducts, options.costLimit));
+      }
+    }
+
+    if(options.verbose){
+      mult.print(*output);
+      *output << "   SIZE:" << mult.operators.size() << endl;
+    }
+    stats.allocatedBytes += counter.allocatedBytes;
+
+    int leastOperationCount;
+    ImplicantOperation<Bits> &result = cheapestTerm(mult, leastOperationCount);
+    if(leastOperationCount > prunedCost) provenOptimal = false;
+    printResult(result);
+    return true;
+  }
+
+  /**
+   * @brief Selects the term with the least number of operations of an expansion of petrickTree.
+   * @param mult The expansion, which is a single term if it is not a sum.
+   * @param cost Gets the number of operations of the term.
+   * @return ImplicantOperation<Bits>& The first term with the least operations.
+   */
+  ImplicantOperation<Bits>& cheapestTerm(ImplicantOperation<Bits> &mult, int &cost){
+    int andCount, orCount, notCount;
+    if(mult.type != IMPLICANT_SUM){
+      cost = mult.getOperationCount(numInputs, &andCount, &orCount, &notCount);
+      return mult;
+    }
+    int leastOperationIndex = 0;
+    cost = mult.operators[0].getOperationCount(numInputs, &andCount, &orCount, &notCount);
+    for(size_t i = 1; i < mult.operators.size(); i++){
+      int thisOpCount = mult.operators[i].getOperationCount(numInputs, &andCount, &orCount, &notCount);
+      if(thisOpCount < cost){
+        cost = thisOpCount;
+        leastOperationIndex = i;
+      }
+    }
+    return mult.operators[leastOperationIndex];
+  }
+
+  // Prints the selected product of implicants as the algebraic expression of the function.
+  void printResult(ImplicantOperation<Bits> &result){
+    // Count of the individual gates.
+    int operationCount = result.getOperationCount(numInputs, &resultAnd, &resultOr, &resultNot);
+    if(budget.exceeded){
+      provenOptimal = false;
+      stats.budgetExceeded = true;
+      // Another run with the same limits may find a cheaper result.
+      cacheFile.clear();
+    }
+
+    // The other formats are written with the results of all the functions (see writeResults).
+    bool printed = output && options.format == FORMAT_TEXT;
+    ostringstream text;
+    if(printed){
+      text << this->funcName << ": ";
+      result.printAlgebraic(text, numInputs, options.colored);
+      text << "  Number of operations: " << operationCount <<
+              "(AND: " << resultAnd << ", OR: " << resultOr << ", NOT: " << resultNot << ")";
+      if(options.limitsResult()){
+        text << "  Optimal: " << (provenOptimal ? "yes" : "no");
+      }
+      text << "\n";
+    }
+
+    vector<Implicant<Bits>*> cover;
+    collectImplicants(result, cover);
+    previousCover.clear();
+    resultCover.clear();
+    for(Implicant<Bits> *imp : cover){
+      previousCover.insert(imp->getKey());
+      resultCover.push_back(*imp);
+    }
+    // The functions minimized together are factored together (see MultiFunction::printFactored).
+    if(printed && options.factor && !options.multipleOutputs){
+      FactoredNetwork network(numInputs);
+      network.addFunction(resultCover);
+      network.factor();
+      printFactored(network, 0, text);
+    }
+    // The result is written at once, so that the output isn't written piece by piece.
+    if(printed){
+      string buffer = text.str();
+      output->write(buffer.data(), buffer.size());
+    }
+
+    if(!cacheFile.empty()) storeCachedResult(result);
+  }
+
+  /**
+   * @brief Prints the factored form of the result, with the number of gates it needs.
+   * 
+   * @param network The network where the result was factored.
+   * @param index The index of this function on the network.
+   * @param stream Where it is printed.
+   */
+  void printFactored(FactoredNetwork &network, int index, ostream &stream){
+    int andCount, orCount, notCount;
+    int operationCount = network.getOperationCount({index}, &andCount, &orCount, &notCount);
+    stream << funcName << " factored: [";
+    network.print(stream, network.outputs[index], options.colored);
+    stream << "]  Number of operations: " << operationCount << "(AND: " << andCount << ", OR: " << 
+            orCount << ", NOT: " << notCount << ")\n";
+  }
+
+  /**
+   * @brief Finds the file of the cache with the result of this function, whose name is a hash of the
+   * canonical form of the function and of the options that change its result. On the canonical form, 
+   * the inputs are sorted by a signature that doesn't depend on their order, so the functions that are
+   * the same but for the order of their inputs share their result. The inputs with the same signature 
+   * keep their order, so some of those functions may still get different files. Negated inputs are 
+   * not merged, as the NOT operations make their results cost differently.
+   */
+  void findCacheFile(){
+    // Minterms and Do-Not-Care bits where each input is 1, and the sum of the ones of those.
+    vector<array<uint64_t, 4>> signatures(numInputs);
+    for(Implicant<Bits> &i : originalFunction){
+      int set = i.value.dnc ? 1 : 0;
+      for(uint64_t bits = lowBits(i.value.val); bits != 0; bits &= bits - 1){
+        array<uint64_t, 4> &signature = signatures[__builtin_ctzll(bits)];
+        signature[set]++;
+        signature[2+set] += i.value.bitCount;
+      }
+    }
+    canonicalInputs.clear();
+    for(int i = 0; i < numInputs; i++) canonicalInputs.push_back(i);
+    stable_sort(canonicalInputs.begin(), canonicalInputs.end(), [&](int a, int b){
+      return signatures[a] < signatures[b];
+    });
+
+    // Two hashes of the minterms of the canonical form. The hashes of the minterms are added, so that 
+    // their order doesn't matter.
+    uint64_t seed = 0;
+    for(char c : cacheHeader()) seed = mixHash(seed ^ (uint8_t) c);
+    uint64_t hashes[2] = {mixHash(seed), mixHash(~seed)};
+    for(Implicant<Bits> &i : originalFunction){
+      uint64_t minterm = permuteInputs(lowBits(i.value.val), true) << 1 | i.value.dnc;
+      hashes[0] += mixHash(minterm);
+      hashes[1] += mixHash(minterm ^ 0x5851f42d4c957f2dULL);
+    }
+    char name[33];
+    snprintf(name, sizeof(name), "%016llx%016llx", (unsigned long long) hashes[0], (unsigned long long) hashes[1]);
+    cacheFile = options.cachePath + "/" + name;
+  }
+
+  // First line of the files of the cache, with the options that change the result of the function.
+  string cacheHeader(){
+    return "petrick cache " + to_string(CACHE_VERSION) + " inputs " + to_string(numInputs) + " solver " + 
+           to_string(options.solver) + " max-products " + to_string(options.maxProducts) + " cost-limit " + to_string(options.costLimit);
+  }
+
+  // Moves each input of the bits to its place on the canonical form of the function (see 
+  // canonicalInputs) or, if toCanonical is false, from the canonical form back to the function.
+  uint64_t permuteInputs(uint64_t bits, bool toCanonical){
+    uint64_t result = 0;
+    for(int k = 0; k < numInputs; k++){
+      if(toCanonical) result |= ((bits >> canonicalInputs[k]) & 1) << k;
+      else result |= ((bits >> k) & 1) << canonicalInputs[k];
+    }
+    return result;
+  }
+
+  /**
+   * @brief Reads the result of the function from the cache and prints it.
+   * @return true if the result was on the cache.
+   */
+  bool loadCachedResult(){
+    findCacheFile();
+    ifstream file(cacheFile);
+    string header;
+    if(!getline(file, header) || header != cacheHeader()) return false;
+
+    // A line with the provenOptimal flag, followed by a line with the value and the mask of each
+    // implicant of the result, as they are on the canonical form.
+    bool optimal;
+    uint64_t value, mask;
+    Implicants<Bits> cover;
+    if(!(file >> optimal)) return false;
+    while(file >> value >> mask){
+      cover.push_back(Implicant<Bits>(Bits(permuteInputs(value, false)), 
+                                      Bits(permuteInputs(mask, false)) | ~inputBits<Bits>(numInputs), numInputs));
+    }
+    if(!file.eof() || cover.empty()) return false;
+
+    imps = cover;
+    provenOptimal = optimal;
+    vector<Implicant<Bits>*> product;
+    for(size_t i = 0; i < imps.size(); i++){
+      product.push_back(&imps[i]);
+    }
+    ImplicantOperation<Bits> result = ImplicantOperation<Bits>::productOf(product);
+    cacheFile.clear();
+    printResult(result);
+    return true;
+  }
+
+  void storeCachedResult(ImplicantOperation<Bits> &result){
+    vector<Implicant<Bits>*> cover;
+    collectImplicants(result, cover);
+    // The file is written with another name and then renamed, so that the other threads or processes 
+    // never read half of it.
+    size_t writer = hash<thread::id>()(this_thread::get_id()) ^ 
+                    chrono::steady_clock::now().time_since_epoch().count();
+    string temporaryFile = cacheFile + "." + to_string(writer) + ".tmp";
+    {
+      ofstream file(temporaryFile);
+      file << cacheHeader() << "\n" << provenOptimal << "\n";
+      for(Implicant<Bits> *imp : cover){
+        file << permuteInputs(lowBits(imp->value.val), true) << " " 
+             << permuteInputs(lowBits(imp->commonBitsMask.val), true) << "\n";
+      }
+      if(!file) cover.clear();
+    }
+    error_code error;
+    if(cover.empty()) filesystem::remove(temporaryFile, error);
+    else filesystem::rename(temporaryFile, cacheFile, error);
+    cacheFile.clear();
+  }
+
+  // Adds the implicants of the leaves of the operation to list.
+  void collectImplicants(ImplicantOperation<Bits> &op, vector<Implicant<Bits>*> &list){
+    if(op.imp) list.push_back(op.imp);
+    for(ImplicantOperation<Bits> &subOp : op.operators){
+      collectImplicants(subOp, list);
+    }
+  }
+
+  /**
+   * @brief Calculates the prime implicants (imps) from the BDD of the cubes of the function and of its
+   * Do-Not-Care bits (see DecisionDiagram), instead of joining its minterms, and fills originalFunction
+   * with only the minterms of the function, for the chart. The bitmaps are left empty, so that 
+   * setMinterm lists all the minterms again. If the budget is hit, imps are the cubes of the function.
+   */
+  void calculatePrimesBDD(){
+    if(numInputs > MAX_EXPANDED_INPUTS){
+      throw invalid_argument("Functions of more than " + to_string(MAX_EXPANDED_INPUTS) + 
+                             " inputs can only be minimized with the espresso solver");
+    }
+    onBitmap.clear();
+    dncBitmap.clear();
+
+    DecisionDiagram diagram;
+    diagram.budget = &budget;
+    int on = diagram.bddOf(onSet, numInputs);
+    int dnc = diagram.bddOf(dncSet, numInputs);
+    if(!budget.exceeded && diagram.bddAnd(on, dnc) != 0){
+      throw invalid_argument("Input of two minterms as Do not care and Do care");
     }
+    diagram.getCubes(diagram.primes(diagram.bddOr(on, dnc)), numInputs, imps);
+    stats.bddNodes = diagram.bddNodes.size() + diagram.zddNodes.size();
+    if(budget.exceeded) imps = onSet;
+    // The cubes that are repeated on onSet are only kept once.
+    Implicants<Bits> uniqueImps;
+    for(Implicant<Bits> &imp : imps){
+      if(impsKeys.insert(imp.getKey()).second) uniqueImps.push_back(imp);
+    }
+    imps.swap(uniqueImps);
+    stats.primeCount = imps.size();
 
-    cout << "  Number of operations: " << leastOperationCount <<
-            "(AND: " << andCount << ", OR: " << orCount << ", NOT: " << notCount << ")" << endl;
+    // The minterms of the function, sorted and without the repeated ones.
+    vector<uint64_t> minterms;
+    for(Implicant<Bits> &cube : onSet){
+      cube.forEachMinterm([&](Bits m){ minterms.push_back(lowBits(m)); });
+    }
+    sort(minterms.begin(), minterms.end());
+    minterms.erase(unique(minterms.begin(), minterms.end()), minterms.end());
+    originalFunction.clear();
+    for(uint64_t m : minterms){
+      originalFunction.push_back(Implicant<Bits>(Minterm<Bits>(Bits(m))));
+    }
   }
 
   void calculateImplicants(){
     // Copy the minterms to the implicants.
-    for(int i = 0; i < originalFunction.size(); i++){
-      Implicant copy({originalFunction[i]});
+    for(size_t i = 0; i < originalFunction.size(); i++){
+      Implicant<Bits> copy({originalFunction[i]});
       imps.push_back(copy);
+      impsKeys.insert(copy.getKey());
     }
 
     // Group the implicants. Max implicant group has the size of the number of bits (inputs of function).
     int previousImplicantsAddedCount = imps.size();
     for(int impSize = 0; impSize < numInputs; impSize++){
-      // Stores the indexes of the implicants that have been combined so that after this iteration, they are marked as no essential
-      // as they have been 'reduced' to other implicant.
-      vector<int> impIndexCombined;
-      // Number of new implicants in this loop iteration. This is a simple optimization to reduce steps in the inner loop.
+      // Once the budget is hit, the implicants of the last iteration are kept as they are: they still 
+      // cover the function, as each of the others was joined into one of them.
+      if(budget.check(imps.size()*sizeof(Implicant<Bits>))) break;
+      // Search for a pair of compatible implicants between the implicants added on the last iteration of this loop.
+      vector<ImplicantJoin<Bits>> joins;
+      timeStage("joinImplicants", [&](){
+        joinImplicants(imps.size()-previousImplicantsAddedCount, imps.size(), joins);
+      });
+
+      // Number of new implicants in this loop iteration.
       int newImplicantsCount = 0;
-      // Search for a pair of compatible implicants, starting from the last implicant added on the last iteration of this loop.
-      for(int i = imps.size()-previousImplicantsAddedCount; i < imps.size(); i++){
-        for(int j = i+1; j < imps.size()-newImplicantsCount; j++){
-          // imps[i].print();
-          // cout << " ";
-          // imps[j].print();
-          // cout << endl;
-
-          Implicant newImp;
-          if(!imps[i].joinWith(imps[j], newImp)) continue;
-
-          // If the originals can be combined, then they were not essentials.
-          impIndexCombined.push_back(i);
-          impIndexCombined.push_back(j);
-          
-          if(implicantListContains(newImp)) continue;
-
-          imps.push_back(newImp);
+      timeStage("deduplicateImplicants", [&](){
+        for(ImplicantJoin<Bits> &join : joins){
+          if(!impsKeys.insert(join.result.getKey()).second) continue;
+
+          imps.push_back(join.result);
           newImplicantsCount++;
         }
-      }
+      });
+      stats.duplicateJoins += joins.size() - newImplicantsCount;
 
-      // Mark reduced implicants as non essential.
-      for(int i : impIndexCombined){
-        imps[i].essential = false;
+      // If the originals can be combined, then they were not essentials. They are marked after the
+      // iteration as they have been 'reduced' to other implicant. When minimizing several functions at
+      // once, they are still needed if the new implicant is not one of all their functions.
+      for(ImplicantJoin<Bits> &join : joins){
+        if(join.result.outputs == imps[join.first].outputs) imps[join.first].essential = false;
+        if(join.result.outputs == imps[join.second].outputs) imps[join.second].essential = false;
       }
 
       previousImplicantsAddedCount = newImplicantsCount;
     }
   }
 
-  void removeNonEssentialImplicants(){
-    for(auto it = imps.begin(); it != imps.end();){
-      Implicant imp = *it;
-      if(!imp.essential) it = imps.erase(it);
-      else it++;
+  /**
+   * @brief Joins all the compatible pairs of implicants inside imps[first, last). Only implicants 
+   * with the same mask and whose values differ in one bit can be joined, so the implicants are 
+   * grouped in buckets by mask and by number of ones of their value, and only the buckets of 
+   * adjacent number of ones are compared.
+   * 
+   * @param first Index of the first implicant of imps to join.
+   * @param last Index after the last implicant of imps to join.
+   * @param joins Output list of joined pairs, sorted by the indexes of the pair.
+   */
+  void joinImplicants(int first, int last, vector<ImplicantJoin<Bits>> &joins){
+    // buckets[mask][bitCount] stores the implicants with said mask and number of ones.
+    map<Bits, vector<ImplicantBucket<Bits>>> buckets;
+    for(int i = first; i < last; i++){
+      vector<ImplicantBucket<Bits>> &group = buckets[imps[i].commonBitsMask.val];
+      int bitCount = imps[i].value.bitCount;
+      if((int) group.size() <= bitCount) group.resize(bitCount+1);
+      group[bitCount].indexes.push_back(i);
+      group[bitCount].values.push_back(imps[i].value.val);
     }
 
-    if(imps.size() == 0){
-      throw runtime_error("This function does not have essential implicants (wut?)");      
+    // Each pair of adjacent buckets is joined on its own, so the pairs can be joined in parallel. The 
+    // buckets with many implicants are split so that the work is spread between the threads.
+    const int chunkSize = 64;
+    vector<BucketPair<Bits>> pairs;
+    for(auto &maskGroup : buckets){
+      vector<ImplicantBucket<Bits>> &group = maskGroup.second;
+      for(size_t bitCount = 0; bitCount+1 < group.size(); bitCount++){
+        if(group[bitCount+1].indexes.empty()) continue;
+        for(int begin = 0; begin < (int) group[bitCount].indexes.size(); begin += chunkSize){
+          int end = min<int>(begin + chunkSize, group[bitCount].indexes.size());
+          pairs.push_back(BucketPair<Bits>{&group[bitCount], &group[bitCount+1], begin, end});
+        }
+      }
+    }
+
+    // Each pair has its own list of joins, which are merged afterwards. Once the budget is hit, the 
+    // pairs that are left are not joined: their implicants stay on the list, so the function is still 
+    // covered.
+    vector<vector<ImplicantJoin<Bits>>> pairJoins(pairs.size());
+    atomic<uint64_t> attempts(0), joinCount(0);
+    atomic<bool> stopped(false);
+    auto joinPair = [&](int p){
+      if(stopped || budget.isOver((imps.size() + joinCount)*sizeof(Implicant<Bits>))){
+        stopped = true;
+        return;
+      }
+      uint64_t pairAttempts = 0;
+      BucketPair<Bits> &pair = pairs[p];
+      // The implicants of both buckets have the same mask, so they can be joined if their values differ
+      // on a single bit.
+      vector<int> adjacent(pair.upper->values.size());
+      for(int index = pair.begin; index < pair.end; index++){
+        int i = pair.lower->indexes[index];
+        int adjacentCount = findAdjacentValues(pair.lower->values[index], pair.upper->values.data(), 
+                                               pair.upper->values.size(), adjacent.data());
+        pairAttempts += pair.upper->values.size();
+        for(int a = 0; a < adjacentCount; a++){
+          int j = pair.upper->indexes[adjacent[a]];
+          ImplicantJoin<Bits> join(min(i, j), max(i, j));
+          if(!imps[i].joinWith(imps[j], join.result)) continue;
+          pairJoins[p].push_back(join);
+        }
+      }
+      attempts += pairAttempts;
+      joinCount += pairJoins[p].size();
+    };
+    if(pool) pool->parallelFor(pairs.size(), joinPair);
+    else for(size_t p = 0; p < pairs.size(); p++) joinPair(p);
+    if(stopped) budget.exceeded = true;
+
+    for(vector<ImplicantJoin<Bits>> &list : pairJoins){
+      joins.insert(joins.end(), list.begin(), list.end());
     }
+    stats.joinAttempts += attempts;
+    stats.joinSuccesses += joins.size();
+
+    // Keep the same order as if every pair of implicants had been compared one after the other.
+    sort(joins.begin(), joins.end());
   }
 
-  bool implicantListContains(Implicant i){
-    for(Implicant listImp : imps){
-      if(listImp == i) return true;
+  void removeNonEssentialImplicants(){
+    removePrimes([](Implicant<Bits> &imp){ return !imp.essential; });
+
+    if(imps.size() == 0){
+      throw runtime_error("This function does not have essential implicants (wut?)");      
     }
-    return false;
+    stats.primeCount = imps.size();
   }
 
   void nameImplicants(){
     char letter = 'A';
-    for(int i = 0; i < imps.size(); i++){
+    for(size_t i = 0; i < imps.size(); i++){
       imps[i].name = letter++;
-      imps[i].printDetailed();
-      cout << endl;
+      imps[i].printDetailed(*output);
+      *output << endl;
     }
   }
 
   // @return 0 if it is a minterm, 1 if it is a 'do not care' bit, and -1 if it has not been found.
   int searchMinterm(int n){
-    for(int i = 0; i < originalFunction.size(); i++){
-      Minterm x = originalFunction[i][0];
-      if(x.val == n) return x.dnc;
-    }
+    if((onBitmap[n/64]>>(n%64))&0x01) return 0;
+    if((dncBitmap[n/64]>>(n%64))&0x01) return 1;
     return -1;
   }
-}Function;
+};
+
+/**
+ * @brief Several functions of the same inputs (the outputs of a truth table) minimized together, so 
+ * that the product terms shared by several functions are built only once. The implicants of all the
+ * functions are calculated at once, tagged with the functions they are implicants of (see 
+ * Implicant::outputs), and the chart of all the functions is covered with BranchAndBound.
+ */
+template<typename Bits>
+struct MultiFunction{
+  vector<Function<Bits>> functions;
+  int numInputs;
+  // Where the results (and the verbose information) are printed. If null, nothing is printed.
+  ostream *output = &cout;
+  // Threads used to join the implicants. If zero, they are joined on the calling thread.
+  ThreadPool *pool = 0;
+  Options options = DEFAULT_OPTIONS;
+  // Gates of all the functions, with the shared product terms counted once.
+  int totalAnd = 0, totalOr = 0, totalNot = 0;
+  // As Function::statsLine, for the stats of all the functions.
+  string statsLine;
+
+  MultiFunction(vector<Function<Bits>> &funcs, int nInp) : functions(funcs), numInputs(nInp){
+    if(funcs.size() > 64){
+      throw invalid_argument("At most 64 functions can be minimized together");
+    }
+  }
+
+  void reduce(){
+    // Every minterm of any function, tagged with the functions where it is a minterm or a Do-Not-Care.
+    map<Bits, uint64_t> mintermOutputs;
+    vector<Minterms<Bits>> outputMinterms(functions.size());
+    for(size_t f = 0; f < functions.size(); f++){
+      functions[f].expandFunction();
+      for(Implicant<Bits> &i : functions[f].originalFunction){
+        mintermOutputs[i[0].val] |= 1ULL << f;
+        if(!i[0].dnc) outputMinterms[f].push_back(i[0]);
+      }
+    }
+
+    Function<Bits> combined(Implicants<Bits>(), Implicants<Bits>(), numInputs, "");
+    combined.output = output;
+    combined.pool = pool;
+    combined.options = options;
+    combined.budget = Budget(options);
+    for(auto &minterm : mintermOutputs){
+      Implicant<Bits> imp(Minterm<Bits>(minterm.first));
+      imp.outputs = minterm.second;
+      combined.originalFunction.push_back(imp);
+    }
+
+    vector<vector<int>> covers(functions.size());
+    bool optimal = true;
+    if(!combined.originalFunction.empty()){
+      combined.calculateImplicants();
+      combined.timeStage("removeNonEssentialImplicants", [&](){ combined.removeNonEssentialImplicants(); });
+      if(options.verbose){
+        combined.nameImplicants();
+      }
+
+      // Take the essential rows out of the chart and search the cheapest cover of the rest.
+      combined.timeStage("petrick", [&](){
+        PrimeChart chart(combined.imps, outputMinterms, numInputs);
+        chart.reduce(&combined.budget);
+        vector<int> rows = chart.selectedRows;
+        // Petrick's method is not used on charts of several outputs, so sop searches as bnb.
+        SolverType solver = options.solver == SOLVER_AUTO ? chooseCoverSolver(chart) : options.solver;
+        if(solver == SOLVER_SOP || combined.budget.exceeded) solver = SOLVER_BNB;
+        combined.stats.coreRows = chart.getActiveRows().size();
+        combined.stats.coreColumns = chart.getActiveColumns().size();
+        vector<int> coreRows;
+        BranchAndBound search(chart);
+        search.budget = &combined.budget;
+        if(solver == SOLVER_GREEDY){
+          coreRows = search.solveGreedy(optimal);
+        }else if(solver == SOLVER_BNB || !combined.ilpCover(chart, coreRows)){
+          solver = SOLVER_BNB;
+          coreRows = search.solve();
+        }
+        combined.stats.coverSolver = combined.stats.coreColumns == 0 ? "none" : SOLVER_NAMES[solver];
+        combined.stats.searchNodes += search.searchNodes;
+        rows.insert(rows.end(), coreRows.begin(), coreRows.end());
+        for(int row : rows){
+          covers[chart.rowOutputs[row]].push_back(chart.rowImplicants[row]);
+        }
+      });
+    }
+
+    // The operations of the implicants that are shared by several functions are only counted once.
+    int andCount = 0, orCount = 0, notCount = 0;
+    vector<bool> counted(combined.imps.size(), false);
+    for(size_t f = 0; f < functions.size(); f++){
+      functions[f].output = output;
+      functions[f].options = options;
+      functions[f].resultCover.clear();
+      functions[f].resultAnd = functions[f].resultOr = functions[f].resultNot = 0;
+      if(outputMinterms[f].empty()){
+        functions[f].printEmptyResult();
+        continue;
+      }
+
+      sort(covers[f].begin(), covers[f].end());
+      vector<Implicant<Bits>*> product;
+      for(int index : covers[f]){
+        product.push_back(&combined.imps[index]);
+        if(!counted[index]){
+          combined.imps[index].getOperationCount(numInputs, &andCount, &notCount);
+          counted[index] = true;
+        }
+      }
+      orCount += covers[f].size() - 1;
+      ImplicantOperation<Bits> result = ImplicantOperation<Bits>::productOf(product);
+      functions[f].provenOptimal = optimal;
+      functions[f].budget = combined.budget;
+      functions[f].printResult(result);
+    }
+
+    totalAnd = andCount;
+    totalOr = orCount;
+    totalNot = notCount;
+    if(!output) return;
+    if(options.format == FORMAT_TEXT){
+      *output << "Total number of operations: " << andCount + orCount + notCount <<
+              "(AND: " << andCount << ", OR: " << orCount << ", NOT: " << notCount << ")" << endl;
+      if(options.factor) printFactored();
+    }
+
+    if(options.stats){
+      // The stats are the ones of all the functions minimized together.
+      string names;
+      for(size_t f = 0; f < functions.size(); f++){
+        names += (f > 0 ? "," : "") + functions[f].funcName;
+      }
+      combined.stats.budgetExceeded = combined.budget.exceeded;
+      if(options.format == FORMAT_TEXT){
+        combined.stats.print(*output, names, numInputs);
+      }else{
+        ostringstream line;
+        combined.stats.print(line, names, numInputs);
+        statsLine = line.str();
+      }
+    }
+  }
+
+  // Prints the factored form of the results, where the subexpressions are shared by all the functions.
+  void printFactored(){
+    FactoredNetwork network(numInputs);
+    vector<int> indexes;
+    for(size_t f = 0; f < functions.size(); f++){
+      network.addFunction(functions[f].resultCover);
+      if(!functions[f].resultCover.empty()) indexes.push_back(f);
+    }
+    network.factor();
+    for(int f : indexes){
+      functions[f].printFactored(network, f, *output);
+    }
+    int andCount, orCount, notCount;
+    int operationCount = network.getOperationCount(indexes, &andCount, &orCount, &notCount);
+    *output << "Total factored operations: " << operationCount << "(AND: " << andCount << ", OR: " << 
+            orCount << ", NOT: " << notCount << ")" << endl;
+  }
+};
+
+/**
+ * @brief Read-only view of the contents of a file. The file is mapped into memory, so it isn't read
+ * until its contents are used. On Windows, the file is read into a buffer instead.
+ */
+typedef struct MappedFile{
+  const uint8_t *data = 0;
+  size_t size = 0;
+
+  MappedFile(const string &path){
+#ifdef _WIN32
+    ifstream file(path, ios::binary);
+    if(!file) throw runtime_error("The file '" + path + "' could not be opened.");
+    buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    data = (const uint8_t*) buffer.data();
+    size = buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0){
+      if(fd >= 0) close(fd);
+      throw runtime_error("The file '" + path + "' could not be opened.");
+    }
+    size = info.st_size;
+    if(size > 0){
+      void *mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(mapping == MAP_FAILED){
+        close(fd);
+        throw runtime_error("The file '" + path + "' could not be mapped into memory.");
+      }
+      data = (const uint8_t*) mapping;
+    }
+    close(fd);
+#endif
+  }
+
+  ~MappedFile(){
+#ifndef _WIN32
+    if(data) munmap((void*) data, size);
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  private:
+#ifdef _WIN32
+  vector<char> buffer;
+#endif
+}MappedFile;
 
 // Function to display the help menu
 void displayHelp() {
-    cout << "Usage: ./petrick [-hvc]<numInputs> [<minterms>] [<dncs>]\n";
+    cout << "Usage: ./petrick [-hvcm] [-j<n>] [--solver=<s>] <numInputs> [<minterms>] [<dncs>] ...\n";
+    cout << "       ./petrick [-hvcm] [-j<n>] [--solver=<s>] --table=<file>\n";
+    cout << "       ./petrick [-hvcm] [-j<n>] [--solver=<s>] --binary=<file>\n";
+    cout << "       ./petrick [-hvcm] [-j<n>] [--solver=<s>] --batch < <file>\n";
     cout << "Example: ./petrick 3 [1,2,3] [4,5,6]\n\n";
     cout << "Arguments:\n";
     cout << "-h  --help   : Display this help menu.\n";
     cout << "-v  --verbose: Verbose mode displays more info on the process.\n";
     cout << "-c  --colored: Negated terms shown in red, non-negated in green.\n";
+    cout << "-m  --multiple: Minimize all the functions together, so that they can share\n";
+    cout << "               their product terms.\n";
+    cout << "-j<n> -j <n> --jobs=<n>: Use n threads to minimize the functions, which are\n";
+    cout << "               minimized at the same time. With -j alone (not followed by a\n";
+    cout << "               number), uses as many threads as the processor has.\n";
+    cout << "--max-products=<k>: Only keep the k cheapest partial products of Petrick's method\n";
+    cout << "               (sop and tree solvers). The result shows if it can be proven the\n";
+    cout << "               cheapest one.\n";
+    cout << "--cost-limit=<c>: Drop the partial products of Petrick's method that already have\n";
+    cout << "               more than c operations (sop and tree solvers). The result shows\n";
+    cout << "               if it can be proven the cheapest one.\n";
+    cout << "--time-limit=<s>: Stop the minimization of each function after s seconds and print\n";
+    cout << "               the best result found until then, which may not be the cheapest one.\n";
+    cout << "--mem-limit=<MB>: Stop the minimization of each function when its implicants, products\n";
+    cout << "               or nodes would take more than MB megabytes, as with --time-limit. The\n";
+    cout << "               size is estimated from their number, not measured from the process.\n";
+    cout << "--stats     : After the result of each function, print a JSON line with the time\n";
+    cout << "               of each stage and counters of the minimization (see FunctionStats).\n";
+    cout << "--factor    : After each result, print its factored form with the gates it needs\n";
+    cout << "               when the NOT gates and the common subexpressions are shared (with\n";
+    cout << "               -m, by all the functions).\n";
+    cout << "--bdd       : Calculate the prime implicants from the binary decision diagram of\n";
+    cout << "               the function, without listing its Do-Not-Care bits one by one, for\n";
+    cout << "               the functions with large Do-Not-Care sets.\n";
+    cout << "--format=<f> : How the results are written:\n";
+    cout << "               text   : The expression and the gates of each function (default).\n";
+    cout << "               pla    : A Berkeley PLA table of each group of functions.\n";
+    cout << "               verilog: A Verilog module with an assign for each function.\n";
+    cout << "               json   : A JSON line for each function, with its cubes and gates.\n";
+    cout << "--cache=<dir>: Store the results on a directory and reuse them for the functions that\n";
+    cout << "               are the same (but for the order of their inputs) on later runs.\n";
+    cout << "--table=<file>: Read the functions from the truth table of a file, with a row\n";
+    cout << "               like \"0 1 x | 1 0\" for each group of inputs. Each output is a\n";
+    cout << "               function, named Q0, Q1... from left to right.\n";
+    cout << "--binary=<file>: Read the functions from a binary file, with their minterms as\n";
+    cout << "               bitmaps or as cubes (see readBinaryFunctions on petrick.cpp).\n";
+    cout << "--batch      : Read the functions from the standard input, with the arguments\n";
+    cout << "               <numInputs> [<minterms>] [<dncs>] ... of each group of functions\n";
+    cout << "               on a line. The results are printed in the same order.\n";
+    cout << "--solver=<s> : Algorithm used to select the implicants:\n";
+    cout << "               sop : Petrick's method with bitset products (default).\n";
+    cout << "               tree: Petrick's method with algebraic expansion.\n";
+    cout << "               bnb : Branch and bound search of the cheapest cover.\n";
+    cout << "               espresso: Heuristic minimization for functions with many inputs.\n";
+    cout << "                     The result may not be the cheapest one.\n";
+    cout << "               greedy: Fast weighted set cover of the chart, which may not be the\n";
+    cout << "                     cheapest one.\n";
+    cout << "               ilp : Cheapest cover of the chart as an integer program, solved by\n";
+    cout << "                     Z3 (only if built with -DPETRICK_Z3 -lz3).\n";
+    cout << "               auto: bnb, ilp or greedy, chosen by the size of the chart.\n";
     cout << "<numInputs>  : The number of inputs of the logic function.\n";
     cout << "[<minterms>] : The minterms of the function. Must be a comma-separated list of\n";
     cout << "               numbers enclosed in [].\n";
     cout << "[<dncs>]     : The Do-Not-Care terms of the function. Must be a comma-separated \n";
     cout << "               list of numbers enclosed in [].\n";
+    cout << "               Both lists may also contain cubes: the bits of the inputs from first\n";
+    cout << "               to last, with x on the bits that may be 0 or 1 (e.g. [1,0x1x]).\n";
+    cout << "...          : More pairs of [<minterms>] [<dncs>] for more functions (outputs) of\n";
+    cout << "               the same inputs, named Q0, Q1...\n";
+}
+
+/**
+ * @brief Parses a non-negative decimal number.
+ * @param begin of the text of the number.
+ * @param end of the text of the number (the character after its last digit).
+ * @return the number.
+ */
+int parseNumber(const char *begin, const char *end) {
+    int64_t number = 0;
+    for (const char *c = begin; c != end && number <= INT32_MAX; c++) {
+        if (*c < '0' || *c > '9') number = INT64_MAX;
+        else number = 10*number + (*c - '0');
+    }
+    if (begin == end || number > INT32_MAX) {
+        throw invalid_argument("Invalid number '" + string(begin, end) + "'.");
+    }
+    return number;
+}
+
+/**
+ * @brief Parses a minterm of a function, written as a non-negative decimal number.
+ * @param begin of the text of the minterm.
+ * @param end of the text of the minterm (the character after its last digit).
+ * @param numInputs of the function, which limit the value of the minterm.
+ * @return the minterm.
+ */
+template<typename Bits>
+Bits parseMinterm(const char *begin, const char *end, int numInputs) {
+    Bits largest = inputBits<Bits>(numInputs);
+    Bits number = 0;
+    for (const char *c = begin; c != end; c++) {
+        if (*c < '0' || *c > '9') {
+            throw invalid_argument("Invalid number '" + string(begin, end) + "'.");
+        }
+        Bits digit = *c - '0';
+        if (digit > largest || number > (largest - digit) / 10) {
+            throw invalid_argument("The minterm " + string(begin, end) + " is greater than the largest "
+                                   "one of " + to_string(numInputs) + " inputs.");
+        }
+        number = (number << 3) + (number << 1) + digit;
+    }
+    if (begin == end) throw invalid_argument("Invalid number ''.");
+    return number;
 }
 
-// Function to parse an array from a string (e.g., "[1,2,3]")
-Minterms parseArrayToMinterms(const string& arrayStr) {
-    Minterms result;
+// Function to parse an array from a string (e.g., "[1,2,3]"). The elements can also be cubes, written
+// as the bits of the inputs from first to last with an 'x' on the bits that can be either 0 or 1 
+// (e.g., "[1,0x1x,3]" stands for the minterms 1, 3, 4, 5, 6 and 7 of a function of four inputs).
+// The string is read only once, without splitting it into copies of its elements.
+template<typename Bits>
+Implicants<Bits> parseArrayToCubes(const char *arrayStr, int numInputs) {
+    Implicants<Bits> result;
     
     // Ensure the input string starts with '[' and ends with ']'
-    if (arrayStr.front() != '[' || arrayStr.back() != ']') {
-        cerr << "Error: Array should be enclosed in [].\n";
-        return result;
+    const char *end = arrayStr + strlen(arrayStr);
+    if (end - arrayStr < 2 || arrayStr[0] != '[' || end[-1] != ']') {
+        throw invalid_argument("Array should be enclosed in [].");
     }
     
-    // Remove the brackets
-    string innerStr = arrayStr.substr(1, arrayStr.size() - 2);
-    
-    // Split the string by commas
-    stringstream ss(innerStr);
-    string num;
-    
-    while (getline(ss, num, ',')) {
-        result.push_back(Minterm(stoi(num)));
+    // Read the elements between the brackets, separated by commas.
+    const char *element = arrayStr + 1;
+    end--;
+    while (element < end) {
+        const char *elementEnd = find(element, end, ',');
+        if (find_first_of(element, elementEnd, "xX-", "xX-" + 3) == elementEnd) {
+            // A minterm, written as a decimal number.
+            result.push_back(Minterm<Bits>(parseMinterm<Bits>(element, elementEnd, numInputs)));
+        } else {
+            if (elementEnd - element != numInputs) {
+                throw invalid_argument("The cube " + string(element, elementEnd) + 
+                                       " must have one bit for each input.");
+            }
+            Bits value = 0, mask = ~Bits(0);
+            for (int i = 0; i < numInputs; i++) {
+                Bits bit = Bits(1) << (numInputs-1-i);
+                if (element[i] == '1') value |= bit;
+                else if (element[i] != '0') mask &= ~bit;
+            }
+            result.push_back(Implicant<Bits>(value, mask, numInputs));
+        }
+        element = elementEnd + 1;
     }
     
     return result;
 }
 
-int main(int argc, char* argv[]){
-    // Check if help is requested.
-    if (argc == 2 && (string(argv[1]) == "--help" || string(argv[1]) == "-h")) {
-        displayHelp();
+/**
+ * @brief Parses the arguments that define a group of functions: the number of inputs followed by a 
+ * pair of lists (minterms and Do-Not-Care terms) for each function.
+ * @param argCount is the number of arguments.
+ * @param args are the arguments. The first one, the number of inputs, has already been parsed.
+ * @param numInputs is the number of inputs of the functions.
+ * @param functions gets the functions, named Q if there is only one and Q0, Q1... otherwise.
+ */
+template<typename Bits>
+void parseFunctions(int argCount, char **args, int numInputs, vector<Function<Bits>> &functions) {
+    // Parse the rest of arguments as pairs of arrays, one pair for each function.
+    int functionCount = (argCount-1)/2;
+    for (int i = 0; i < functionCount; i++) {
+        Implicants<Bits> minterms = parseArrayToCubes<Bits>(args[1+2*i], numInputs);
+        Implicants<Bits> dnc = parseArrayToCubes<Bits>(args[2+2*i], numInputs);
+        string name = functionCount == 1 ? "Q" : "Q" + to_string(i);
+        functions.push_back(Function<Bits>(minterms, dnc, numInputs, name));
+    }
+}
+
+/**
+ * @brief With a format other than text, writes the results of the functions once all of them are 
+ * reduced, each one followed by its stats line on json, and the stats lines after all of them on the
+ * other formats.
+ * @param groupStats is the stats line of all the functions when they were reduced together (-m).
+ */
+template<typename Bits>
+void writeFunctionResults(vector<Function<Bits>> &functions, int numInputs, ostream &output, 
+                          const string &groupStats = "") {
+    if (DEFAULT_OPTIONS.format == FORMAT_TEXT) return;
+    if (DEFAULT_OPTIONS.format == FORMAT_JSON && groupStats.empty()) {
+        for (Function<Bits> &func : functions) {
+            writeResults(output, FORMAT_JSON, numInputs, {func.getResult()});
+            output << func.statsLine;
+        }
+        return;
+    }
+    vector<FunctionResult> results;
+    for (Function<Bits> &func : functions) results.push_back(func.getResult());
+    writeResults(output, DEFAULT_OPTIONS.format, numInputs, results);
+    output << groupStats;
+    for (Function<Bits> &func : functions) output << func.statsLine;
+}
+
+/**
+ * @brief Reduces a group of functions of the same inputs and prints their results in order.
+ * @param functions to reduce.
+ * @param numInputs of the functions.
+ * @param pool with the threads used to reduce the functions.
+ * @param output where the results are printed.
+ */
+template<typename Bits>
+void reduceFunctions(vector<Function<Bits>> &functions, int numInputs, ThreadPool &pool, ostream &output) {
+    if (DEFAULT_OPTIONS.multipleOutputs) {
+        MultiFunction<Bits> multi(functions, numInputs);
+        multi.pool = &pool;
+        multi.output = &output;
+        multi.reduce();
+        writeFunctionResults(multi.functions, numInputs, output, multi.statsLine);
+        return;
+    }
+
+    // Reduce the functions at the same time and print the results in order. The threads that are not
+    // reducing a function help to join the implicants of the others.
+    bool buffered = pool.size() > 1 && functions.size() > 1;
+    vector<ostringstream> results(buffered ? functions.size() : 0);
+    pool.parallelFor(functions.size(), [&](int i){
+      Function<Bits> &func = functions[i];
+      func.pool = &pool;
+      func.output = buffered ? &results[i] : &output;
+      if(func.onSet.size() == 0){
+        func.printEmptyResult();
+        return;
+      }
+      func.reduce();
+    });
+    for(ostringstream &result : results){
+      output << result.str();
+    }
+    writeFunctionResults(functions, numInputs, output);
+}
+
+/**
+ * @brief Parses the arguments that define a group of functions, as in parseFunctions, and reduces 
+ * them with the type of bits of their number of inputs (see withInputBits).
+ * @param argCount is the number of arguments.
+ * @param args are the arguments.
+ * @param pool with the threads used to reduce the functions.
+ * @param output where the results are printed.
+ */
+void reduceArguments(int argCount, char **args, ThreadPool &pool, ostream &output) {
+    if (argCount < 3 || (argCount-1) % 2 != 0) {
+        throw invalid_argument("Invalid number of arguments.");
+    }
+    int numInputs;
+    try {
+        numInputs = parseNumber(args[0], args[0] + strlen(args[0]));
+    } catch (invalid_argument&) {
+        throw invalid_argument("The first argument must be a valid number.");
+    }
+
+    withInputBits(numInputs, [&](auto bits){
+        vector<Function<decltype(bits)>> functions;
+        parseFunctions(argCount, args, numInputs, functions);
+        reduceFunctions(functions, numInputs, pool, output);
+    });
+}
+
+/**
+ * @brief Reduces the functions given on each line of the standard input, with the same arguments as 
+ * on the command line (e.g. "3 [1,2,3] [4,5,6]"), and prints their results in the same order. The 
+ * lines that are already on the input are read in groups that are reduced at the same time.
+ * @param pool with the threads used to reduce the functions.
+ * @return 0 if all the lines could be reduced, -1 otherwise.
+ */
+int reduceBatch(ThreadPool &pool) {
+    // The buffers of each group are kept between groups so that their memory is reused.
+    const int groupSize = 64;
+    vector<string> lines(groupSize);
+    vector<ostringstream> results(groupSize);
+    vector<string> errors(groupSize);
+    vector<vector<char*>> args(groupSize);
+
+    int returnValue = 0;
+    int firstLine = 1;
+    while (cin) {
+        // Wait for a line, and only group it with the lines that have already arrived, so that each 
+        // result is printed as soon as it can be (e.g. when the lines are sent one by one on a pipe).
+        int lineCount = 0;
+        while (lineCount < groupSize && (lineCount == 0 || cin.rdbuf()->in_avail() > 0) &&
+               getline(cin, lines[lineCount])) lineCount++;
+
+        pool.parallelFor(lineCount, [&](int l){
+          results[l].str("");
+          errors[l].clear();
+
+          // Split the line into its arguments in place, ending each one with '\0'.
+          string &line = lines[l];
+          args[l].clear();
+          for (size_t i = 0; i < line.size(); i++) {
+            if (isspace((unsigned char) line[i])) {
+              line[i] = '\0';
+            } else if (i == 0 || line[i-1] == '\0') {
+              args[l].push_back(&line[i]);
+            }
+          }
+          // Skip the empty lines.
+          if (args[l].empty()) return;
+
+          try {
+            reduceArguments(args[l].size(), args[l].data(), pool, results[l]);
+          } catch (exception &e) {
+            errors[l] = e.what();
+          }
+        });
+
+        for (int l = 0; l < lineCount; l++) {
+          cout << results[l].str();
+          if (!errors[l].empty()) {
+            cout.flush();
+            cerr << "Error on line " << firstLine + l << ": " << errors[l] << "\n";
+            returnValue = -1;
+          }
+        }
+        cout.flush();
+        firstLine += lineCount;
+    }
+    return returnValue;
+}
+
+// A row of a truth table: the bits of its inputs, from first to last, and the bits of its outputs.
+typedef struct TableRow{
+  string inputs;
+  string outputs;
+}TableRow;
+
+/**
+ * @brief Reads a truth table from a file, with a row for each group of inputs: the bits of the inputs 
+ * from first to last, a '|' and the bits of the outputs (e.g. "0 1 x | 1 0"). An 'x' on the inputs 
+ * stands for both 0 and 1, and on the outputs marks a Do-Not-Care.
+ * @param path of the file with the truth table.
+ * @param numInputs is set to the number of inputs of the table.
+ * @param rows gets the rows of the table, which getTableFunctions turns into functions.
+ * @return true if the table could be read.
+ */
+bool readTruthTable(const string &path, int &numInputs, vector<TableRow> &rows) {
+    ifstream file(path);
+    if (!file) {
+        cerr << "Error: The file '" << path << "' could not be opened.\n";
+        return false;
+    }
+
+    numInputs = -1;
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        TableRow row;
+        bool onOutputs = false, valid = true;
+        for (char c : line) {
+            if (c == ' ' || c == '\t' || c == '\r') continue;
+            if (c == '|' && !onOutputs) {
+                onOutputs = true;
+            } else if (c != '0' && c != '1' && c != 'x' && c != 'X' && c != '-') {
+                valid = false;
+                break;
+            } else if (onOutputs) {
+                row.outputs.push_back(c);
+            } else {
+                row.inputs.push_back(c);
+            }
+        }
+        int inputCount = row.inputs.size();
+        // Skip the empty lines.
+        if (valid && !onOutputs && inputCount == 0) continue;
+
+        if (!valid || !onOutputs || inputCount == 0 || row.outputs.empty()) {
+            cerr << "Error: Invalid row on line " << lineNumber << " of the truth table.\n";
+            return false;
+        }
+        if (numInputs == -1) {
+            numInputs = inputCount;
+        } else if (inputCount != numInputs || row.outputs.size() != rows[0].outputs.size()) {
+            cerr << "Error: The row on line " << lineNumber << " of the truth table has a different "
+                    "number of inputs or outputs than the first one.\n";
+            return false;
+        }
+        rows.push_back(row);
+    }
+
+    if (numInputs == -1) {
+        cerr << "Error: The truth table is empty.\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Gets the functions of the rows of a truth table. Each row is kept as a single cube, so the x 
+ * are not expanded into minterms.
+ * @param rows of the truth table, as read by readTruthTable.
+ * @param numInputs of the truth table.
+ * @param functions gets a function for each output of the table, named Q0, Q1... from left to right.
+ */
+template<typename Bits>
+void getTableFunctions(vector<TableRow> &rows, int numInputs, vector<Function<Bits>> &functions) {
+    vector<Implicants<Bits>> onSets(rows[0].outputs.size()), dncSets(rows[0].outputs.size());
+    for (TableRow &row : rows) {
+        // The one-bits (value) and the x bits (dashes) of the inputs of this row.
+        Bits value = 0, dashes = 0;
+        for (char c : row.inputs) {
+            value = (value << 1) | (c == '1');
+            dashes = (dashes << 1) | (c != '0' && c != '1');
+        }
+
+        Implicant<Bits> cube(value, ~dashes, numInputs);
+        for (size_t i = 0; i < row.outputs.size(); i++) {
+            if (row.outputs[i] == '1') onSets[i].push_back(cube);
+            else if (row.outputs[i] != '0') dncSets[i].push_back(cube);
+        }
+    }
+
+    for (size_t i = 0; i < onSets.size(); i++) {
+        functions.push_back(Function<Bits>(onSets[i], dncSets[i], numInputs, "Q" + to_string(i)));
+    }
+}
+
+/**
+ * @brief Reads the functions of a binary file. All the numbers are little-endian:
+ *  - Header: the characters "PTRK", then three uint32: the version (1), the number of inputs and the 
+ *    number of functions.
+ *  - For each function, a uint32 with its format:
+ *    - 0 (bitmaps): the ON-set and then the DC-set as bitmaps of 2^inputs bits, on uint64 words. The 
+ *      bit m of the word m/64 is set if the minterm m belongs to the set.
+ *    - 1 (cubes): two uint32 with the number of cubes of the ON-set and of the DC-set, followed by 
+ *      their cubes as pairs of uint32 (value, mask). The bits of mask are 1 on the inputs that are 
+ *      not x, and value has the value of those inputs. Both have to fit on the inputs.
+ * The numbers are read from the mapping of the file, without parsing any text, but each minterm of
+ * the bitmaps and each cube is still copied into the sets of its Function, which keeps them as 
+ * Implicants.
+ * @param path of the file.
+ * @param numInputs is set to the number of inputs of the functions.
+ * @param functions gets the functions, named Q if there is only one and Q0, Q1... otherwise.
+ */
+void readBinaryFunctions(const string &path, int &numInputs, vector<Function<uint32_t>> &functions) {
+    MappedFile file(path);
+    size_t position = 0;
+    // Reads the next uint32 of the file.
+    auto next = [&]() -> uint32_t {
+        if (file.size - position < 4) throw runtime_error("The binary file '" + path + "' is truncated.");
+        const uint8_t *bytes = file.data + position;
+        position += 4;
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+    };
+
+    if (file.size < 4 || memcmp(file.data, "PTRK", 4) != 0) {
+        throw runtime_error("The file '" + path + "' is not a binary file of functions.");
+    }
+    position = 4;
+    if (next() != 1) throw runtime_error("Unknown version of the binary file '" + path + "'.");
+    numInputs = next();
+    uint32_t functionCount = next();
+    if (numInputs < 1 || numInputs > 31) {
+        throw runtime_error("The binary file '" + path + "' has an invalid number of inputs.");
+    }
+    // The bits outside the inputs are 1 on the mask of an implicant.
+    uint32_t outsideMask = ~((1u << numInputs) - 1);
+
+    for (uint32_t f = 0; f < functionCount; f++) {
+        Implicants<uint32_t> sets[2];
+        uint32_t format = next();
+        if (format == 0) {
+            uint64_t wordCount = ((1ull << numInputs) + 63) / 64;
+            if ((file.size - position) / 16 < wordCount) {
+                throw runtime_error("The binary file '" + path + "' is truncated.");
+            }
+            for (Implicants<uint32_t> &set : sets) {
+                const uint8_t *words = file.data + position;
+                for (uint64_t w = 0; w < wordCount; w++) {
+                    uint64_t word = 0;
+                    for (int b = 7; b >= 0; b--) word = (word << 8) | words[8*w + b];
+                    for (; word != 0; word &= word - 1) {
+                        set.push_back(Minterm<uint32_t>(64*w + __builtin_ctzll(word)));
+                    }
+                }
+                position += 8*wordCount;
+            }
+        } else if (format == 1) {
+            uint32_t counts[2] = {next(), next()};
+            for (int i = 0; i < 2; i++) {
+                if ((file.size - position) / 8 < counts[i]) {
+                    throw runtime_error("The binary file '" + path + "' is truncated.");
+                }
+                sets[i].reserve(counts[i]);
+                for (uint32_t c = 0; c < counts[i]; c++) {
+                    uint32_t value = next();
+                    uint32_t mask = next();
+                    if ((value | mask) & outsideMask) {
+                        throw runtime_error("The cubes of the binary file '" + path + "' must have " + 
+                                            to_string(numInputs) + " inputs.");
+                    }
+                    sets[i].push_back(Implicant<uint32_t>(value, mask | outsideMask, numInputs));
+                }
+            }
+        } else {
+            throw runtime_error("Unknown format of a function of the binary file '" + path + "'.");
+        }
+        string name = functionCount == 1 ? "Q" : "Q" + to_string(f);
+        functions.push_back(Function<uint32_t>(sets[0], sets[1], numInputs, name));
+    }
+}
+
+/**
+ * @brief Reduces the functions given to the library (see petrick.h) without printing them, and 
+ * stores their results.
+ * @param numInputs of the functions.
+ * @param functions to reduce, with count of them.
+ * @param options of the reduction.
+ * @param pool with the threads used to reduce the functions.
+ * @param results where the result of each function is stored.
+ * @param total where the gates of all the functions together are stored, with multipleOutputs.
+ */
+template<typename Bits>
+void reduceLibraryFunctions(int numInputs, size_t count, const PetrickFunction *functions, 
+                            const Options &options, ThreadPool &pool, PetrickResult *results, 
+                            PetrickResult *total){
+    Bits inputs = inputBits<Bits>(numInputs);
+    vector<Function<Bits>> funcs;
+    for (size_t f = 0; f < count; f++) {
+        const PetrickCube *cubes[2] = {functions[f].onSet, functions[f].dncSet};
+        size_t cubeCounts[2] = {functions[f].onCount, functions[f].dncCount};
+        Implicants<Bits> sets[2];
+        for (int s = 0; s < 2; s++) {
+            for (size_t c = 0; c < cubeCounts[s]; c++) {
+                if (((cubes[s][c].value | cubes[s][c].mask) & ~lowBits(inputs)) != 0) {
+                    throw invalid_argument("The cubes of the functions must have " + to_string(numInputs) + " inputs.");
+                }
+                sets[s].push_back(Implicant<Bits>(Bits(cubes[s][c].value), Bits(cubes[s][c].mask) | ~inputs, numInputs));
+            }
+        }
+        funcs.push_back(Function<Bits>(sets[0], sets[1], numInputs, "Q" + to_string(f)));
+        funcs.back().options = options;
+        funcs.back().output = 0;
+    }
+
+    vector<Function<Bits>> *reduced = &funcs;
+    MultiFunction<Bits> multi(funcs, numInputs);
+    if (options.multipleOutputs) {
+        multi.pool = &pool;
+        multi.output = 0;
+        multi.options = options;
+        multi.reduce();
+        reduced = &multi.functions;
+        if (total) {
+            *total = PetrickResult();
+            total->andCount = multi.totalAnd;
+            total->orCount = multi.totalOr;
+            total->notCount = multi.totalNot;
+            total->operations = multi.totalAnd + multi.totalOr + multi.totalNot;
+            total->optimal = 1;
+            for (Function<Bits> &func : multi.functions) {
+                if (!func.provenOptimal) total->optimal = 0;
+            }
+        }
+    } else {
+        pool.parallelFor(funcs.size(), [&](int i){
+          funcs[i].pool = &pool;
+          if(funcs[i].onSet.size() > 0) funcs[i].reduce();
+        });
+    }
+
+    for (size_t f = 0; f < count; f++) {
+        Function<Bits> &func = (*reduced)[f];
+        PetrickResult &result = results[f];
+        result.cubeCount = func.resultCover.size();
+        result.cubes = result.cubeCount > 0 ? new PetrickCube[result.cubeCount] : 0;
+        for (size_t c = 0; c < result.cubeCount; c++) {
+            Implicant<Bits> &imp = func.resultCover[c];
+            result.cubes[c] = PetrickCube{lowBits(imp.value.val), lowBits(imp.commonBitsMask.val & inputs)};
+        }
+        result.andCount = func.resultAnd;
+        result.orCount = func.resultOr;
+        result.notCount = func.resultNot;
+        result.operations = func.resultAnd + func.resultOr + func.resultNot;
+        result.optimal = func.provenOptimal;
+    }
+}
+
+extern "C" PetrickOptions petrickDefaultOptions(void){
+    Options defaults;
+    PetrickOptions options;
+    options.solver = defaults.solver;
+    options.maxProducts = defaults.maxProducts;
+    options.costLimit = defaults.costLimit;
+    options.threads = 1;
+    options.multipleOutputs = defaults.multipleOutputs;
+    options.cachePath = 0;
+    options.timeLimit = defaults.timeLimit;
+    options.memLimit = 0;
+    options.bddPrimes = defaults.bddPrimes;
+    return options;
+}
+
+extern "C" int petrickReduceFunctions(int numInputs, size_t count, const PetrickFunction *functions,
+                                      const PetrickOptions *options, PetrickResult *results, 
+                                      PetrickResult *total, char *error, size_t errorSize){
+    for (size_t f = 0; f < count; f++) results[f] = PetrickResult();
+    try {
+        PetrickOptions given = options ? *options : petrickDefaultOptions();
+        if (numInputs < 1 || numInputs > PETRICK_MAX_INPUTS) {
+            throw invalid_argument("The number of inputs must be between 1 and " + to_string(PETRICK_MAX_INPUTS) + ".");
+        }
+        if (given.solver < SOLVER_SOP || given.solver > SOLVER_AUTO || given.threads < 1) {
+            throw invalid_argument("Invalid options.");
+        }
+#ifndef PETRICK_Z3
+        if (given.solver == SOLVER_ILP) {
+            throw invalid_argument("The ilp solver needs the library to be built with -DPETRICK_Z3 -lz3.");
+        }
+#endif
+        if (given.multipleOutputs && (given.solver == SOLVER_TREE || given.solver == SOLVER_ESPRESSO)) {
+            throw invalid_argument("The functions cannot be minimized together with the tree or espresso solvers.");
+        }
+        if (given.multipleOutputs && given.bddPrimes) {
+            throw invalid_argument("The functions cannot be minimized together with bddPrimes.");
+        }
+
+        // The options that only change what is printed are left disabled, as nothing is printed.
+        Options reduceOptions;
+        reduceOptions.solver = (SolverType) given.solver;
+        reduceOptions.multipleOutputs = given.multipleOutputs != 0;
+        reduceOptions.maxProducts = given.maxProducts;
+        reduceOptions.costLimit = given.costLimit;
+        reduceOptions.bddPrimes = given.bddPrimes != 0;
+        reduceOptions.timeLimit = max(0.0, given.timeLimit);
+        reduceOptions.memLimit = given.memLimit > 0 ? (uint64_t) given.memLimit*1024*1024 : 0;
+        if (given.cachePath) {
+            reduceOptions.cachePath = given.cachePath;
+            error_code createError;
+            filesystem::create_directories(reduceOptions.cachePath, createError);
+            if (reduceOptions.cachePath.empty() || !filesystem::is_directory(reduceOptions.cachePath, createError)) {
+                throw runtime_error("Cannot create the cache directory '" + reduceOptions.cachePath + "'.");
+            }
+        }
+
+        ThreadPool pool(given.threads);
+        withInputBits(numInputs, [&](auto bits){
+            reduceLibraryFunctions<decltype(bits)>(numInputs, count, functions, reduceOptions, pool, results, total);
+        });
         return 0;
+    } catch (exception &e) {
+        for (size_t f = 0; f < count; f++) petrickFreeResult(&results[f]);
+        if (error && errorSize > 0) snprintf(error, errorSize, "%s", e.what());
+        return -1;
     }
+}
+
+extern "C" void petrickFreeResult(PetrickResult *result){
+    delete[] result->cubes;
+    result->cubes = 0;
+    result->cubeCount = 0;
+}
 
+// The library (see petrick.h) and benchmark.cpp are built with PETRICK_LIBRARY, so they have no main.
+#ifndef PETRICK_LIBRARY
+int main(int argc, char* argv[]){
+    // Parse the options, which go before the inputs of the function.
     int processedArgs = 0;
-    // Verbose mode.
-    if(argc > 4 && (string(argv[1]) == "-v" || string(argv[2]) == "-v" ||
-       string(argv[1]) == "--verbose" || string(argv[2]) == "--verbose")) {
-      VERBOSE = true;
+    // File with the truth table of the functions, if they are not given as arguments.
+    string tablePath;
+    // File with the functions in binary format, if they are not given as arguments.
+    string binaryPath;
+    // Read the functions from the standard input.
+    bool batch = false;
+    while(1+processedArgs < argc && argv[1+processedArgs][0] == '-'){
+      string option = argv[1+processedArgs];
+      if(option == "-h" || option == "--help"){
+        displayHelp();
+        return 0;
+      }else if(option == "-v" || option == "--verbose"){
+        DEFAULT_OPTIONS.verbose = true;
+      }else if(option == "-c" || option == "--colored"){
+        DEFAULT_OPTIONS.colored = true;
+      }else if(option == "-m" || option == "--multiple"){
+        DEFAULT_OPTIONS.multipleOutputs = true;
+      }else if(option.rfind("-j", 0) == 0 || option.rfind("--jobs=", 0) == 0){
+        string threads = option[1] == 'j' ? option.substr(2) : option.substr(7);
+        // The number of threads may also be the next argument (-j 4).
+        if(option == "-j" && 2+processedArgs < argc && isdigit((unsigned char) argv[2+processedArgs][0])){
+          threads = argv[2+processedArgs];
+          processedArgs++;
+        }
+        try{
+          THREADS = threads.empty() ? max<int>(1, thread::hardware_concurrency()) : stoi(threads);
+        }catch(...){
+          THREADS = 0;
+        }
+        if(THREADS < 1){
+          cerr << "Error: Invalid number of threads '" << threads << "'.\n";
+          return -1;
+        }
+      }else if(option.rfind("--max-products=", 0) == 0 || option.rfind("--cost-limit=", 0) == 0){
+        bool maxProducts = option[2] == 'm';
+        string value = option.substr(option.find('=')+1);
+        try{
+          (maxProducts ? DEFAULT_OPTIONS.maxProducts : DEFAULT_OPTIONS.costLimit) = parseNumber(value.c_str(), value.c_str() + value.size());
+        }catch(invalid_argument&){
+          cerr << "Error: Invalid value '" << value << "' of " << option.substr(0, option.find('=')) << ".\n";
+          return -1;
+        }
+        if(maxProducts && DEFAULT_OPTIONS.maxProducts == 0){
+          cerr << "Error: --max-products must keep at least one product.\n";
+          return -1;
+        }
+      }else if(option.rfind("--time-limit=", 0) == 0 || option.rfind("--mem-limit=", 0) == 0){
+        bool timeLimit = option[2] == 't';
+        string value = option.substr(option.find('=')+1);
+        try{
+          size_t end;
+          double limit = stod(value, &end);
+          if(end != value.size() || !(limit > 0)) throw invalid_argument(value);
+          if(timeLimit) DEFAULT_OPTIONS.timeLimit = limit;
+          else DEFAULT_OPTIONS.memLimit = (uint64_t) (limit*1024*1024);
+        }catch(exception&){
+          cerr << "Error: Invalid value '" << value << "' of " << option.substr(0, option.find('=')) << ".\n";
+          return -1;
+        }
+      }else if(option == "--stats"){
+        DEFAULT_OPTIONS.stats = true;
+      }else if(option == "--factor"){
+        DEFAULT_OPTIONS.factor = true;
+      }else if(option == "--bdd"){
+        DEFAULT_OPTIONS.bddPrimes = true;
+      }else if(option.rfind("--cache=", 0) == 0){
+        DEFAULT_OPTIONS.cachePath = option.substr(8);
+        error_code error;
+        filesystem::create_directories(DEFAULT_OPTIONS.cachePath, error);
+        if(DEFAULT_OPTIONS.cachePath.empty() || !filesystem::is_directory(DEFAULT_OPTIONS.cachePath, error)){
+          cerr << "Error: Cannot create the cache directory '" << DEFAULT_OPTIONS.cachePath << "'.\n";
+          return -1;
+        }
+      }else if(option == "--batch"){
+        batch = true;
+      }else if(option.rfind("--binary=", 0) == 0){
+        binaryPath = option.substr(9);
+      }else if(option.rfind("--table=", 0) == 0){
+        tablePath = option.substr(8);
+      }else if(option.rfind("--solver=", 0) == 0){
+        string solver = option.substr(9);
+        int s = SOLVER_SOP;
+        while(s <= SOLVER_AUTO && solver != SOLVER_NAMES[s]) s++;
+        if(s > SOLVER_AUTO){
+          cerr << "Error: Unknown solver '" << solver << "'.\n";
+          return -1;
+        }
+#ifndef PETRICK_Z3
+        if(s == SOLVER_ILP){
+          cerr << "Error: The ilp solver needs petrick to be built with -DPETRICK_Z3 -lz3.\n";
+          return -1;
+        }
+#endif
+        DEFAULT_OPTIONS.solver = (SolverType) s;
+      }else if(option.rfind("--format=", 0) == 0){
+        string format = option.substr(9);
+        int f = FORMAT_TEXT;
+        while(f <= FORMAT_JSON && format != FORMAT_NAMES[f]) f++;
+        if(f > FORMAT_JSON){
+          cerr << "Error: Unknown format '" << format << "'.\n";
+          return -1;
+        }
+        DEFAULT_OPTIONS.format = (OutputFormat) f;
+      }else{
+        cerr << "Error: Unknown option '" << option << "'.\n";
+        displayHelp();
+        return -1;
+      }
       processedArgs++;
     }
 
-    // Color outputs.
-    if(argc > 4 && (string(argv[1]) == "-c" || string(argv[2]) == "-c" || 
-       string(argv[1]) == "--colored" || string(argv[2]) == "--colored")) {
-      COLORED = true;
-      processedArgs++;
+    if(DEFAULT_OPTIONS.multipleOutputs && (DEFAULT_OPTIONS.solver == SOLVER_TREE || DEFAULT_OPTIONS.solver == SOLVER_ESPRESSO)){
+      cerr << "Error: The functions cannot be minimized together with the tree or espresso solvers.\n";
+      return -1;
+    }
+    if(DEFAULT_OPTIONS.multipleOutputs && DEFAULT_OPTIONS.bddPrimes){
+      cerr << "Error: The functions cannot be minimized together with --bdd.\n";
+      return -1;
+    }
+    ThreadPool pool(THREADS);
+
+    if (batch) {
+        if (!tablePath.empty() || !binaryPath.empty() || argc != 1+processedArgs) {
+            cerr << "Error: The functions of --batch are read from the standard input.\n";
+            return -1;
+        }
+        ios::sync_with_stdio(false);
+        return reduceBatch(pool);
     }
 
-    if (argc != (4+processedArgs)) {
+    if ((!tablePath.empty() || !binaryPath.empty()) && 
+        (argc != 1+processedArgs || (!tablePath.empty() && !binaryPath.empty()))) {
+        cerr << "Error: The functions must be given by only one of the arguments, a truth table "
+                "or a binary file.\n";
+        return -1;
+    }
+    if (tablePath.empty() && binaryPath.empty() && 
+        (argc < (4+processedArgs) || (argc-2-processedArgs) % 2 != 0)) {
         cerr << "Error: Invalid number of arguments.\n";
         displayHelp();
         return -1;
     }
-    // Parse the first argument.
-    int numberOfInputs;
+
     try {
-        numberOfInputs = stoi(argv[1+processedArgs]); 
-    } catch (...) {
-        cerr << "Error: The first argument must be a valid number.\n";
+        if (!tablePath.empty()) {
+            int numberOfInputs;
+            vector<TableRow> rows;
+            if (!readTruthTable(tablePath, numberOfInputs, rows)) return -1;
+            withInputBits(numberOfInputs, [&](auto bits){
+                vector<Function<decltype(bits)>> functions;
+                getTableFunctions(rows, numberOfInputs, functions);
+                reduceFunctions(functions, numberOfInputs, pool, cout);
+            });
+        } else if (!binaryPath.empty()) {
+            // The binary files have up to 31 inputs, so their cubes always fit on uint32_t.
+            int numberOfInputs;
+            vector<Function<uint32_t>> functions;
+            readBinaryFunctions(binaryPath, numberOfInputs, functions);
+            reduceFunctions(functions, numberOfInputs, pool, cout);
+        } else {
+            reduceArguments(argc-1-processedArgs, argv+1+processedArgs, pool, cout);
+        }
+    } catch (exception &e) {
+        cout.flush();
+        cerr << "Error: " << e.what() << "\n";
         return -1;
     }
-
-    // Parse the second and third arguments as arrays.
-    Minterms minterms = parseArrayToMinterms(argv[2+processedArgs]);
-    Minterms dnc = parseArrayToMinterms(argv[3+processedArgs]);
-
-    if(minterms.size() == 0){
-      cout << "Q: 0" << endl;
-      return 0;
-    }
-
-    // Generate function, reduce and print the results.
-    Function func = Function(minterms, dnc, numberOfInputs, "Q");
-    func.reduce();
-
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,196 @@
+/************************************************************************************************//*
+* @file petrick.h
+* @brief Interface of the petrick library, to reduce logic functions from other programs without
+* running the petrick command. It is a C interface, so that it can be used from any language (see
+* LogicReducer.py), with a C++ wrapper at the end of the file.
+*
+* @project   Logic Function Reducer
+* @version   1.0
+* @date      2026-10-14
+* @author    @dabecart
+*
+* @license
+* This project is licensed under the MIT License - see the LICENSE file for details.
+***************************************************************************************************/
+
+#ifndef PETRICK_H
+#define PETRICK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The functions of the library have up to 64 inputs, so that their cubes fit on uint64_t.
+#define PETRICK_MAX_INPUTS 64
+
+// Solvers of PetrickOptions, as the --solver option of petrick.
+#define PETRICK_SOLVER_SOP      0
+#define PETRICK_SOLVER_TREE     1
+#define PETRICK_SOLVER_BNB      2
+#define PETRICK_SOLVER_ESPRESSO 3
+#define PETRICK_SOLVER_GREEDY   4
+// Only if the library was built with -DPETRICK_Z3.
+#define PETRICK_SOLVER_ILP      5
+#define PETRICK_SOLVER_AUTO     6
+
+/**
+ * @brief A cube of a function: the mask has a 1 on the inputs that are not x, and the value has the
+ * bits of those inputs. The bit numInputs-1 is the first input (a) and the bit 0 is the last one, as
+ * on the minterms of petrick, so the minterm m is the cube {m, (1 << numInputs) - 1}.
+ */
+typedef struct PetrickCube{
+  uint64_t value;
+  uint64_t mask;
+}PetrickCube;
+
+// The minterms (onSet) and Do-Not-Care bits (dncSet) of a function, given as cubes.
+typedef struct PetrickFunction{
+  const PetrickCube *onSet;
+  size_t onCount;
+  const PetrickCube *dncSet;
+  size_t dncCount;
+}PetrickFunction;
+
+// Options of petrickReduceFunctions, which are the same as the ones of the petrick command.
+typedef struct PetrickOptions{
+  // One of the PETRICK_SOLVER values.
+  int solver;
+  // See --max-products and --cost-limit. 0 and -1 to disable them.
+  int maxProducts;
+  int costLimit;
+  // Threads used to reduce the functions (see -j).
+  int threads;
+  // If the functions are reduced together, sharing their product terms (see -m).
+  int multipleOutputs;
+  // Directory of the cache of results (see --cache), or null to not use it.
+  const char *cachePath;
+  // Seconds and megabytes that the reduction of each function may take (see --time-limit and 
+  // --mem-limit). 0 for no limit.
+  double timeLimit;
+  int memLimit;
+  // If the prime implicants are calculated from the BDD of each function (see --bdd). The functions
+  // cannot be reduced together with it.
+  int bddPrimes;
+}PetrickOptions;
+
+/**
+ * @brief The reduced function: the cubes of its sum of products and its number of gates. An empty
+ * function (without minterms) has no cubes.
+ */
+typedef struct PetrickResult{
+  PetrickCube *cubes;
+  size_t cubeCount;
+  int operations;
+  int andCount;
+  int orCount;
+  int notCount;
+  // 0 if the result may not be the one with the least number of operations (see Optimal on petrick).
+  int optimal;
+}PetrickResult;
+
+// The options of the petrick command when it is run without any.
+PetrickOptions petrickDefaultOptions(void);
+
+/**
+ * @brief Reduces a group of functions of the same inputs. It can be called from several threads at
+ * once, as each call keeps its own state.
+ *
+ * @param numInputs The number of inputs of the functions, from 1 to PETRICK_MAX_INPUTS (31 if the
+ * solver is not espresso).
+ * @param count The number of functions.
+ * @param functions The functions to reduce.
+ * @param options The options of the reduction. If null, petrickDefaultOptions is used.
+ * @param results Where the count results are stored, to be freed with petrickFreeResult.
+ * @param total If not null and multipleOutputs is set, gets the gates of all the functions with the
+ * shared product terms counted once. It has no cubes.
+ * @param error If not null, gets the message of the error when the functions cannot be reduced.
+ * @param errorSize The size of the error buffer.
+ * @return 0 on success, -1 if the functions cannot be reduced (and results is left empty).
+ */
+int petrickReduceFunctions(int numInputs, size_t count, const PetrickFunction *functions,
+                           const PetrickOptions *options, PetrickResult *results, PetrickResult *total,
+                           char *error, size_t errorSize);
+
+// Frees the cubes of a result of petrickReduceFunctions.
+void petrickFreeResult(PetrickResult *result);
+
+#ifdef __cplusplus
+}
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+namespace petrick{
+
+typedef struct Function{
+  std::vector<PetrickCube> onSet;
+  std::vector<PetrickCube> dncSet;
+}Function;
+
+typedef struct Cover{
+  std::vector<PetrickCube> cubes;
+  int operations = 0;
+  int andCount = 0;
+  int orCount = 0;
+  int notCount = 0;
+  bool optimal = true;
+}Cover;
+
+// The cube of the minterm m of a function of numInputs inputs.
+inline PetrickCube minterm(uint64_t m, int numInputs){
+  return PetrickCube{m, numInputs >= 64 ? ~0ULL : (1ULL << numInputs) - 1};
+}
+
+/**
+ * @brief Reduces a group of functions as petrickReduceFunctions, but throws runtime_error if they
+ * cannot be reduced.
+ *
+ * @param total If not null and multipleOutputs is set, gets the gates of all the functions together.
+ * @return std::vector<Cover> The result of each function.
+ */
+inline std::vector<Cover> reduceFunctions(int numInputs, const std::vector<Function> &functions,
+                                          const PetrickOptions &options = petrickDefaultOptions(),
+                                          Cover *total = 0){
+  std::vector<PetrickFunction> views;
+  for(const Function &f : functions){
+    views.push_back(PetrickFunction{f.onSet.data(), f.onSet.size(), f.dncSet.data(), f.dncSet.size()});
+  }
+  std::vector<PetrickResult> results(functions.size());
+  PetrickResult totalResult = PetrickResult();
+  char error[256];
+  if(petrickReduceFunctions(numInputs, views.size(), views.data(), &options, results.data(),
+                            &totalResult, error, sizeof(error)) != 0){
+    throw std::runtime_error(error);
+  }
+
+  std::vector<Cover> covers;
+  for(PetrickResult &r : results){
+    Cover cover;
+    cover.cubes.assign(r.cubes, r.cubes + r.cubeCount);
+    cover.operations = r.operations;
+    cover.andCount = r.andCount;
+    cover.orCount = r.orCount;
+    cover.notCount = r.notCount;
+    cover.optimal = r.optimal != 0;
+    petrickFreeResult(&r);
+    covers.push_back(cover);
+  }
+  if(total){
+    *total = Cover();
+    total->operations = totalResult.operations;
+    total->andCount = totalResult.andCount;
+    total->orCount = totalResult.orCount;
+    total->notCount = totalResult.notCount;
+    total->optimal = totalResult.optimal != 0;
+  }
+  return covers;
+}
+
+}
+#endif
+
+#endif
@@ -0,0 +1,260 @@
+# **************************************************************************************************
+# @file regression.py
+# @brief Runs the petrick program on the cases that broke it before (malformed binary files, wide
+# functions, time and memory limits, the --batch protocol, the exact solvers) and checks its answers. It prints a line
+# for each check and exits with 1 if any of them fails.
+#
+# Usage: python3 regression.py [path of petrick, ./petrick by default]
+# incremental.cpp, which checks Function::addMinterm and removeMinterm, is built with g++ (or $CXX).
+#
+# @project   Logic Function Reducer
+# @version   1.0
+# @date      2026-10-14
+# @author    @dabecart
+#
+# @license
+# This project is licensed under the MIT License - see the LICENSE file for details.
+# **************************************************************************************************
+
+import json, os, random, re, select, struct, subprocess, sys, tempfile, time
+
+PETRICK = sys.argv[1] if len(sys.argv) > 1 else "./petrick"
+failures = 0
+
+# Prints the result of a check and counts it if it failed.
+def check(name: str, passed: bool, detail: str = ""):
+    global failures
+    print(("ok    " if passed else "FAIL  ") + name + ("" if passed or not detail else ": " + detail))
+    if not passed:
+        failures += 1
+
+# Runs petrick with the arguments and returns its exit code, standard output and standard error.
+def run(args: list, stdin: str = None, timeout: float = 60):
+    result = subprocess.run([PETRICK] + args, input=stdin, capture_output=True, text=True, timeout=timeout)
+    return result.returncode, result.stdout, result.stderr
+
+# Runs petrick as run does and also returns the most memory it used, in megabytes.
+def runMeasured(args: list):
+    process = subprocess.Popen([PETRICK] + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    out = process.stdout.read()
+    err = process.stderr.read()
+    _, status, usage = os.wait4(process.pid, 0)
+    return os.waitstatus_to_exitcode(status), out, err, usage.ru_maxrss / 1024
+
+# A binary file of functions (see readBinaryFunctions on petrick.cpp) with one function of cubes.
+def binaryCubes(numInputs: int, onCubes: list, dncCubes: list) -> bytes:
+    data = b"PTRK" + struct.pack("<IIII", 1, numInputs, 1, 1)
+    data += struct.pack("<II", len(onCubes), len(dncCubes))
+    for value, mask in onCubes + dncCubes:
+        data += struct.pack("<II", value, mask)
+    return data
+
+def checkBinaryReader(directory: str):
+    path = os.path.join(directory, "cubes.bin")
+    with open(path, "wb") as file:
+        file.write(binaryCubes(4, [(0b0001, 0b1111), (0b0011, 0b1111)], []))
+    code, out, err = run(["--binary=" + path])
+    check("binary file of cubes", code == 0 and out.startswith("Q: #a#bd "), out + err)
+
+    # Cubes with bits outside the inputs, on the value or on the mask.
+    for value, mask in [(0b10000, 0), (0, 0b110000)]:
+        with open(path, "wb") as file:
+            file.write(binaryCubes(4, [(1, 0b1111), (value, mask)], []))
+        code, out, err = run(["--binary=" + path])
+        check("binary cube (%d, %d) outside the inputs is rejected" % (value, mask),
+              code != 0 and "must have 4 inputs" in err, out + err)
+
+def checkWideInputs():
+    # The bitmaps of the minterms take 2^inputs/4 bytes (64 MB on 28 inputs), and nothing else of a
+    # function of two minterms should grow with 2^inputs.
+    for numInputs, limit in [(24, 40), (28, 150), (31, 900)]:
+        code, out, err, megabytes = runMeasured([str(numInputs), "[1,3]", "[]"])
+        check("%d inputs with two minterms use %d MB (at most %d)" % (numInputs, megabytes, limit),
+              code == 0 and out.startswith("Q: ") and megabytes <= limit, out + err)
+
+# The minterms (a random fraction onDensity of them) and the Do-Not-Care bits of a function.
+def randomFunction(seed: int, numInputs: int, onDensity: float, dncDensity: float):
+    generator = random.Random(seed)
+    onSet, dncSet = [], []
+    for minterm in range(1 << numInputs):
+        x = generator.random()
+        if x < onDensity:
+            onSet.append(minterm)
+        elif x < onDensity + dncDensity:
+            dncSet.append(minterm)
+    return onSet, dncSet
+
+# A line of --batch with the function.
+def batchLine(numInputs: int, onSet: list, dncSet: list) -> str:
+    return "%d [%s] [%s]\n" % (numInputs, ",".join(map(str, onSet)), ",".join(map(str, dncSet)))
+
+# @return true if the sum of products of the result of petrick covers all the minterms of the
+# function and no minterm outside its Do-Not-Care bits. "a" is the most significant input.
+# The results printed by petrick: the name, the expression and the number of operations of each
+# function, and the total of -m (or None).
+def readResults(out: str):
+    results = re.findall(r"^(Q\d*): \[?([^\]\s]*)\]?(?:\s+Number of operations: (\d+))?", out, re.M)
+    total = re.search(r"^Total number of operations: (\d+)", out, re.M)
+    return [(name, expression, int(operations or 0)) for name, expression, operations in results], \
+           int(total.group(1)) if total else None
+
+# The minterms of an expression of petrick, such as #ab+c, 1 or 0.
+def expressionMinterms(expression: str, numInputs: int) -> set:
+    covered = set()
+    if expression == "0":
+        return covered
+    for term in expression.split("+"):
+        value, freeInputs, negated = 0, set(range(numInputs)), False
+        for char in term:
+            if char == "#":
+                negated = True
+                continue
+            if char == "1":
+                continue
+            input = ord(char) - ord("a")
+            freeInputs.discard(input)
+            if not negated:
+                value |= 1 << (numInputs-1-input)
+            negated = False
+        minterms = [value]
+        for input in freeInputs:
+            minterms += [m | 1 << (numInputs-1-input) for m in minterms]
+        covered.update(minterms)
+    return covered
+
+def coversFunction(out: str, numInputs: int, onSet: list, dncSet: list) -> bool:
+    results, _ = readResults(out)
+    if not results:
+        return False
+    covered = expressionMinterms(results[0][1], numInputs)
+    return set(onSet) <= covered and covered <= set(onSet) | set(dncSet)
+
+def checkLimits():
+    # When a limit is hit, the best cover found until then must be printed right away, from any stage:
+    # the joins of the implicants, the reduction of the chart, the greedy cover or the absorptions.
+    # None of these functions take less than 2 seconds without the limits.
+    cases = [(16, 0.3, 0.0, ["--time-limit=1"]),
+             (16, 0.45, 0.3, ["--time-limit=1"]),
+             (16, 0.3, 0.0, ["--time-limit=1", "--solver=greedy"]),
+             (16, 0.3, 0.0, ["--time-limit=1", "--solver=bnb"]),
+             (10, 0.4, 0.0, ["--time-limit=1", "--mem-limit=5"]),
+             (10, 0.4, 0.0, ["--mem-limit=1"])]
+    for numInputs, onDensity, dncDensity, options in cases:
+        onSet, dncSet = randomFunction(1, numInputs, onDensity, dncDensity)
+        start = time.time()
+        code, out, err = run(["--stats", "--batch"] + options, batchLine(numInputs, onSet, dncSet))
+        elapsed = time.time() - start
+        stats = json.loads(out.splitlines()[-1]) if code == 0 and out else {}
+        check("%d inputs with %s stop after %.1f s (at most 2 s)" % (numInputs, " ".join(options), elapsed),
+              code == 0 and elapsed <= 2 and stats.get("budgetExceeded") and
+              coversFunction(out, numInputs, onSet, dncSet), out[-300:] + err)
+
+def checkBatch():
+    # Each line sent to --batch must get its result before the next line is sent, as the result of
+    # the same function given on the command line.
+    process = subprocess.Popen([PETRICK, "--batch"], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                               stderr=subprocess.PIPE, text=True)
+    for args in [["3", "[1,2,3]", "[4,5,6]"], ["4", "[0,1,2,5,6,7,8,9,10,14]", "[]"]]:
+        _, expected, _ = run(args)
+        process.stdin.write(" ".join(args) + "\n")
+        process.stdin.flush()
+        ready, _, _ = select.select([process.stdout], [], [], 5)
+        result = process.stdout.readline() if ready else ""
+        check("--batch answers the line '%s' right away" % " ".join(args), result == expected, result)
+    process.stdin.close()
+    check("--batch ends at the end of the input", process.wait(5) == 0, process.stderr.read())
+
+# The truth table of the example of README.md, as the rows of its inputs and outputs.
+def readmeTable() -> list:
+    with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), "README.md")) as file:
+        text = file.read()
+    block = text[text.index("```", text.index("For the [truth table]")):]
+    block = block[3:block.index("```", 3)]
+    return [line.split("|") for line in block.strip().splitlines()]
+
+# The ON-set and the DC-set of each output of the rows of a truth table.
+def tableFunctions(rows: list):
+    numInputs = len(rows[0][0].split())
+    functions = [(set(), set()) for _ in rows[0][1].split()]
+    for inputs, outputs in rows:
+        minterms = [0]
+        for bit in inputs.split():
+            minterms = [m << 1 | b for m in minterms for b in ([0] if bit == "0" else [1] if bit == "1" else [0, 1])]
+        for (onSet, dncSet), output in zip(functions, outputs.split()):
+            (onSet if output == "1" else dncSet if output != "0" else set()).update(minterms)
+    return numInputs, [(sorted(onSet), sorted(dncSet - onSet)) for onSet, dncSet in functions]
+
+# The reason why the solvers do not give the cheapest valid cover of all the functions, or None.
+def solverMismatch(args: list, numInputs: int, functions: list, solvers: list, multiple: bool):
+    costs = {}
+    for solver in solvers:
+        code, out, err = run(["--solver=" + solver] + (["-m"] if multiple else []) + args)
+        results, total = readResults(out)
+        if code != 0 or len(results) != len(functions) or (multiple and total is None):
+            return "%s failed: %s" % (solver, (out + err)[-300:])
+        for (name, expression, _), (onSet, dncSet) in zip(results, functions):
+            covered = expressionMinterms(expression, numInputs)
+            if not set(onSet) <= covered <= set(onSet) | set(dncSet):
+                return "%s gives %s = %s, which is not the function" % (solver, name, expression)
+        costs[solver] = total if multiple else [operations for _, _, operations in results]
+    if len(set(map(str, costs.values()))) > 1:
+        return "the costs are not the same: %s" % costs
+    return None
+
+def checkSolvers(directory: str):
+    # The exact solvers must give valid covers of the same cost, of each function on its own and
+    # of all of them together with -m (which the tree solver does not support).
+    solvers = ["sop", "tree", "bnb"]
+    # ilp is only checked if petrick was built with -DPETRICK_Z3 -lz3.
+    code, _, _ = run(["--solver=ilp", "1", "[1]", "[]"])
+    if code == 0:
+        solvers.append("ilp")
+    for multiple in [False, True]:
+        names = [s for s in solvers if not multiple or s != "tree"]
+        mode = " with -m" if multiple else ""
+
+        path = os.path.join(directory, "table.txt")
+        rows = readmeTable()
+        with open(path, "w") as file:
+            file.write("\n".join("|".join(row) for row in rows) + "\n")
+        numInputs, functions = tableFunctions(rows)
+        mismatch = solverMismatch(["--table=" + path], numInputs, functions, names, multiple)
+        check("%s agree on the table of README.md%s" % (", ".join(names), mode), mismatch is None, mismatch)
+
+        mismatch = None
+        for seed in range(40):
+            numInputs = 3 + seed % 4
+            # Three functions of 6 inputs may take minutes together.
+            count = 1 + seed % (2 if numInputs == 6 else 3)
+            functions = [randomFunction(100*seed + i, numInputs, 0.4, 0.15) for i in range(count)]
+            args = [str(numInputs)] + ["[%s]" % ",".join(map(str, s)) for f in functions for s in f]
+            mismatch = solverMismatch(args, numInputs, functions, names, multiple)
+            if mismatch:
+                mismatch = "%s: %s" % (" ".join(args), mismatch)
+                break
+        check("%s agree on random functions of 3 to 6 inputs%s" % (", ".join(names), mode), mismatch is None,
+              mismatch)
+
+def checkIncremental(directory: str):
+    # incremental.cpp includes petrick.cpp, so it is built from the sources next to this script.
+    source = os.path.join(os.path.dirname(os.path.abspath(__file__)), "incremental.cpp")
+    program = os.path.join(directory, "incremental")
+    build = subprocess.run([os.environ.get("CXX", "g++"), "-std=gnu++17", "-O2", "-pthread", "-o", program, 
+                            source], capture_output=True, text=True)
+    check("incremental.cpp builds", build.returncode == 0, build.stderr[-300:])
+    if build.returncode != 0:
+        return
+    result = subprocess.run([program], capture_output=True, text=True, timeout=120)
+    check("addMinterm and removeMinterm give the result of a new function", result.returncode == 0, 
+          result.stdout[-300:] + result.stderr)
+
+if __name__ == "__main__":
+    with tempfile.TemporaryDirectory() as directory:
+        checkBinaryReader(directory)
+        checkIncremental(directory)
+        checkSolvers(directory)
+    checkWideInputs()
+    checkLimits()
+    checkBatch()
+    print("%d checks failed" % failures if failures else "All checks passed")
+    sys.exit(1 if failures else 0)